@@ -0,0 +1,46 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+#include <string_view>
+
+// Builds HTTP-style response bodies piece by piece through append/+= and
+// reports time and heap allocations per implementation.
+
+namespace {
+
+using CountedString =
+    BasicString<char, std::char_traits<char>, CountingAllocator<char>>;
+using CountedStdString =
+    std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+constexpr int bodies = 2000;
+constexpr int fields_per_body = 200;
+
+template <typename String> void run(const char *name) {
+  AllocationStats::reset();
+  Timer timer;
+
+  for (int b = 0; b < bodies; ++b) {
+    String body;
+    body += "{\"items\":[";
+    for (int i = 0; i < fields_per_body; ++i) {
+      body += std::string_view("{\"name\":\"");
+      body.append("field-name-value", 16);
+      body += '"';
+      body.append(4, ' ');
+      body += "},";
+    }
+    body += "]}";
+    do_not_optimize(body.size());
+  }
+
+  print_row(name, timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  run<CountedString>("BasicString append");
+  run<CountedStdString>("std::string append");
+}
@@ -0,0 +1,99 @@
+#include "ArenaResource.hpp"
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Simulates request handling that builds thousands of short-lived strings
+// per request, then drops them all. Compares the default allocator with
+// pmr strings on a std::pmr::monotonic_buffer_resource and on an
+// ArenaResource that is reset between requests. Allocation counts are the
+// calls that reached the global heap.
+
+namespace {
+
+using CountedString =
+    BasicString<char, std::char_traits<char>, CountingAllocator<char>>;
+
+constexpr int requests = 500;
+constexpr int strings_per_request = 4000;
+
+// Upstream resource that records how often an arena goes to the heap.
+class CountingResource : public std::pmr::memory_resource {
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    ++AllocationStats::allocations;
+    AllocationStats::bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+};
+
+template <typename String, typename Alloc>
+size_t handle_request(int request, const Alloc &alloc) {
+  std::vector<String> fields;
+  fields.reserve(strings_per_request);
+  size_t total = 0;
+  for (int i = 0; i < strings_per_request; ++i) {
+    String field("X-Request-Header-Name-", alloc);
+    field += std::string_view("value-for-request-and-field-");
+    field.append(static_cast<size_t>((request + i) % 32), 'v');
+    total += field.size();
+    fields.push_back(std::move(field));
+  }
+  return total;
+}
+
+void run_default() {
+  AllocationStats::reset();
+  Timer timer;
+  for (int r = 0; r < requests; ++r)
+    do_not_optimize(
+        handle_request<CountedString>(r, CountingAllocator<char>()));
+  print_row("BasicString default allocator", timer.elapsed_ms(),
+            AllocationStats::allocations);
+}
+
+void run_monotonic() {
+  CountingResource upstream;
+  AllocationStats::reset();
+  Timer timer;
+  for (int r = 0; r < requests; ++r) {
+    std::pmr::monotonic_buffer_resource resource(&upstream);
+    do_not_optimize(handle_request<pmr::BasicString<char>>(
+        r, std::pmr::polymorphic_allocator<char>(&resource)));
+  }
+  print_row("pmr monotonic_buffer_resource", timer.elapsed_ms(),
+            AllocationStats::allocations);
+}
+
+void run_arena() {
+  CountingResource upstream;
+  ArenaResource arena(ArenaResource::default_block_size, &upstream);
+  AllocationStats::reset();
+  Timer timer;
+  for (int r = 0; r < requests; ++r) {
+    do_not_optimize(handle_request<pmr::BasicString<char>>(
+        r, std::pmr::polymorphic_allocator<char>(&arena)));
+    arena.reset();
+  }
+  print_row("pmr ArenaResource, reset per request", timer.elapsed_ms(),
+            AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  run_default();
+  run_monotonic();
+  run_arena();
+}
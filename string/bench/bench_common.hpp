@@ -0,0 +1,64 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+// Shared helpers for the BasicString benchmarks: a wall-clock timer and an
+// allocator that counts how often it reaches the heap.
+
+struct AllocationStats {
+  static inline size_t allocations = 0;
+  static inline size_t bytes = 0;
+
+  static void reset() {
+    allocations = 0;
+    bytes = 0;
+  }
+};
+
+template <typename T> struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <typename U> CountingAllocator(const CountingAllocator<U> &) {}
+
+  T *allocate(size_t n) {
+    ++AllocationStats::allocations;
+    AllocationStats::bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T *p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+  friend bool operator==(const CountingAllocator &, const CountingAllocator &) {
+    return true;
+  }
+};
+
+class Timer {
+public:
+  Timer() : start_(std::chrono::steady_clock::now()) {}
+
+  double elapsed_ms() const {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Keeps the optimizer from discarding a benchmarked value.
+template <typename T> inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void print_row(const char *name, double ms, size_t allocations) {
+  std::printf("%-36s %10.2f ms %12zu allocations\n", name, ms, allocations);
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "StringCase.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Case conversion of a large mixed-case buffer with the word-at-a-time
+// scalar kernel against the dispatched vector one, and header lookups in a
+// case-insensitive table against lowering each name before the lookup.
+
+namespace {
+
+constexpr size_t buffer_size = 16 * 1024 * 1024;
+constexpr int rounds = 20;
+constexpr int lookups = 2000000;
+
+template <typename Op> void run(const char *name, Op op) {
+  AllocationStats::reset();
+  Timer timer;
+  op();
+  print_row(name, timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  std::string text;
+  while (text.size() < buffer_size)
+    text += "Content-Type: Text/HTML; Charset=UTF-8\r\nX-Id: AbC123\r\n";
+  std::string out(text.size(), '\0');
+
+  run("lower (word at a time)", [&] {
+    for (int r = 0; r < rounds; ++r) {
+      string_case::transform_scalar<false>(text.data(), text.size(),
+                                           out.data());
+      do_not_optimize(out[0]);
+    }
+  });
+  run("lower (dispatched)", [&] {
+    for (int r = 0; r < rounds; ++r) {
+      string_case::lower(text.data(), text.size(), out.data());
+      do_not_optimize(out[0]);
+    }
+  });
+
+  // Short names fit the inline buffer; the long ones make the lowered
+  // copy allocate.
+  const std::vector<std::string> names = {
+      "Content-Type",
+      "Content-Length",
+      "Accept-Encoding",
+      "User-Agent",
+      "Access-Control-Allow-Credentials",
+      "Strict-Transport-Security",
+      "Content-Security-Policy-Report-Only",
+      "Cross-Origin-Embedder-Policy"};
+  std::vector<std::string> queries;
+  for (const std::string &name : names) {
+    std::string upper = name;
+    for (char &ch : upper)
+      ch = string_case::unfold(ch);
+    queries.push_back(name);
+    queries.push_back(upper);
+  }
+
+  using Lowered = BasicString<char, std::char_traits<char>,
+                              CountingAllocator<char>>;
+  std::unordered_map<Lowered, int, BasicStringHash<char>,
+                     BasicStringEqual<char>>
+      lowered;
+  using Folded = BasicString<char, CaseInsensitiveTraits<char>,
+                             CountingAllocator<char>>;
+  std::unordered_map<Folded, int,
+                     BasicStringHash<char, CaseInsensitiveTraits<char>>,
+                     BasicStringEqual<char, CaseInsensitiveTraits<char>>>
+      folded;
+  for (size_t i = 0; i < names.size(); ++i) {
+    lowered.emplace(to_lower_copy(std::string_view(names[i]),
+                                  CountingAllocator<char>()),
+                    static_cast<int>(i));
+    folded.emplace(Folded(names[i].c_str()), static_cast<int>(i));
+  }
+
+  run("lookup after to_lower_copy", [&] {
+    long sum = 0;
+    for (int i = 0; i < lookups; ++i) {
+      const std::string &query =
+          queries[static_cast<size_t>(i) % queries.size()];
+      sum += lowered.find(to_lower_copy(std::string_view(query),
+                                        CountingAllocator<char>()))
+                 ->second;
+    }
+    do_not_optimize(sum);
+  });
+  run("case-insensitive lookup", [&] {
+    long sum = 0;
+    for (int i = 0; i < lookups; ++i) {
+      const std::string &query =
+          queries[static_cast<size_t>(i) % queries.size()];
+      sum += folded.find(std::string_view(query))->second;
+    }
+    do_not_optimize(sum);
+  });
+}
@@ -0,0 +1,76 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Character-set searches over padded log fields: std::string against
+// BasicString for trimming (find_first_not_of / find_last_not_of), for
+// finding the characters a JSON writer escapes and for locating the last
+// path separator.
+
+namespace {
+
+constexpr int lines = 200000;
+constexpr int rounds = 5;
+
+template <typename Op> void run(const char *name, Op op) {
+  Timer timer;
+  for (int r = 0; r < rounds; ++r)
+    op();
+  std::printf("%-40s %10.2f ms\n", name, timer.elapsed_ms());
+}
+
+template <typename String>
+void run_all(const char *label, const std::vector<String> &fields) {
+  std::string name;
+
+  name = std::string(label) + " trim";
+  run(name.c_str(), [&] {
+    size_t total = 0;
+    for (const String &field : fields) {
+      size_t first = field.find_first_not_of(" \t");
+      size_t last = field.find_last_not_of(" \t");
+      total += first == String::npos ? 0 : last - first + 1;
+    }
+    do_not_optimize(total);
+  });
+
+  name = std::string(label) + " find_first_of (escapes)";
+  run(name.c_str(), [&] {
+    size_t total = 0;
+    for (const String &field : fields)
+      total += field.find_first_of("\"\\\n\r\t\b\f");
+    do_not_optimize(total);
+  });
+
+  name = std::string(label) + " rfind ('/')";
+  run(name.c_str(), [&] {
+    size_t total = 0;
+    for (const String &field : fields)
+      total += field.rfind('/');
+    do_not_optimize(total);
+  });
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> source;
+  for (int i = 0; i < lines; ++i) {
+    std::string field(16 + i % 32, ' ');
+    field += "GET /api/v1/orders/" + std::to_string(i) +
+             "/items?expand=customer,shipping,billing status=200 "
+             "user-agent=Mozilla/5.0 (X11; Linux x86_64)";
+    field.append(8 + i % 24, ' ');
+    source.push_back(std::move(field));
+  }
+
+  std::vector<BasicString<char>> fields;
+  for (const std::string &field : source)
+    fields.emplace_back(field.data(), field.size());
+
+  run_all("std::string", source);
+  run_all("BasicString", fields);
+}
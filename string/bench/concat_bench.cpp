@@ -0,0 +1,56 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+
+// 2-, 4- and 8-way concatenation of heap-sized pieces. BasicString's
+// operator+ builds the result with a single allocation; std::string creates
+// a temporary at every step unless the compiler can reuse rvalue buffers.
+
+namespace {
+
+using CountedString =
+    BasicString<char, std::char_traits<char>, CountingAllocator<char>>;
+using CountedStdString =
+    std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+constexpr int iterations = 200000;
+
+template <typename String> void run(const char *label) {
+  String a(24, 'a'), b(24, 'b'), c(24, 'c'), d(24, 'd');
+  char name[64];
+
+  AllocationStats::reset();
+  Timer two;
+  for (int i = 0; i < iterations; ++i) {
+    String s = a + b;
+    do_not_optimize(s.size());
+  }
+  std::snprintf(name, sizeof(name), "%s, 2-way", label);
+  print_row(name, two.elapsed_ms(), AllocationStats::allocations);
+
+  AllocationStats::reset();
+  Timer four;
+  for (int i = 0; i < iterations; ++i) {
+    String s = a + b + c + d;
+    do_not_optimize(s.size());
+  }
+  std::snprintf(name, sizeof(name), "%s, 4-way", label);
+  print_row(name, four.elapsed_ms(), AllocationStats::allocations);
+
+  AllocationStats::reset();
+  Timer eight;
+  for (int i = 0; i < iterations; ++i) {
+    String s = a + b + c + d + a + b + c + d;
+    do_not_optimize(s.size());
+  }
+  std::snprintf(name, sizeof(name), "%s, 8-way", label);
+  print_row(name, eight.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  run<CountedString>("BasicString");
+  run<CountedStdString>("std::string");
+}
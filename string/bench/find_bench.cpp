@@ -0,0 +1,73 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <string>
+
+// Log-scanning workload: count occurrences of needles of different lengths
+// in a few megabytes of access-log lines.
+
+namespace {
+
+constexpr int passes = 20;
+
+std::string make_log() {
+  std::string log;
+  for (int i = 0; i < 60000; ++i) {
+    log += "2024-05-01T12:00:00Z GET /api/v" + std::to_string(i % 7) +
+           "/items?id=" + std::to_string(i * 31 % 997) + " 200 " +
+           std::to_string(i % 1000) + "ms\n";
+  }
+  log += "2024-05-01T12:00:01Z upstream timed out while reading response "
+         "header from upstream, client: 10.0.0.1\n";
+  return log;
+}
+
+template <typename Find>
+void run(const char *name, size_t hay_size, Find find) {
+  Timer timer;
+  size_t hits = 0;
+  for (int p = 0; p < passes; ++p) {
+    size_t pos = 0;
+    while ((pos = find(pos)) != std::string::npos) {
+      ++hits;
+      ++pos;
+    }
+  }
+  double ms = timer.elapsed_ms();
+  std::printf("%-44s %10.2f ms %8.2f GB/s %8zu hits\n", name, ms,
+              hay_size * passes / ms / 1e6, hits / passes);
+}
+
+} // namespace
+
+int main() {
+  std::string log = make_log();
+  BasicString<char> str(log.c_str());
+
+  const char *needles[] = {
+      "id=996",
+      "upstream timed out",
+      "upstream timed out while reading response header from upstream, "
+      "client: 10.0.0.1",
+  };
+
+  for (const char *needle : needles) {
+    std::string_view sv(needle);
+    char name[64];
+    std::printf("needle length %zu\n", sv.size());
+
+    std::snprintf(name, sizeof(name), "  BasicString::find");
+    run(name, log.size(), [&](size_t pos) { return str.find(sv, pos); });
+
+    std::snprintf(name, sizeof(name), "  std::string::find");
+    run(name, log.size(), [&](size_t pos) { return log.find(sv, pos); });
+
+    std::snprintf(name, sizeof(name), "  std::search (previous find)");
+    run(name, log.size(), [&](size_t pos) {
+      auto it = std::search(log.begin() + pos, log.end(), sv.begin(), sv.end());
+      return it == log.end() ? std::string::npos
+                             : static_cast<size_t>(it - log.begin());
+    });
+  }
+}
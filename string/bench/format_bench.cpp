@@ -0,0 +1,78 @@
+#include "StringFormat.hpp"
+#include "bench_common.hpp"
+
+#include <cstdio>
+#include <string>
+
+// Building "id=<int> latency=<double> user=<name>" log lines into one
+// reused BasicString. The std::string routes format each field into a
+// temporary and copy it over; append_int/append_float write in place.
+// format and append_format are measured where <format> or {fmt} exists.
+
+namespace {
+
+using Counted = BasicString<char, std::char_traits<char>,
+                            CountingAllocator<char>>;
+
+constexpr int lines = 1000000;
+
+template <typename Op> void run(const char *name, Op op) {
+  Counted out;
+  out.reserve(256);
+  AllocationStats::reset();
+  Timer timer;
+  for (int i = 0; i < lines; ++i) {
+    out.clear();
+    op(out, i, i * 0.37 + 0.001);
+    do_not_optimize(out.size());
+  }
+  print_row(name, timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  const Counted user("service-account");
+
+  run("snprintf + append", [&](Counted &out, int id, double latency) {
+    char buffer[128];
+    int n = std::snprintf(buffer, sizeof(buffer), "id=%d latency=%.17g user=",
+                          id, latency);
+    out.append(buffer, static_cast<size_t>(n));
+    out.append(user);
+  });
+
+  run("std::to_string + append", [&](Counted &out, int id, double latency) {
+    std::string id_text = std::to_string(id);
+    std::string latency_text = std::to_string(latency);
+    out.append("id=");
+    out.append(id_text.data(), id_text.size());
+    out.append(" latency=");
+    out.append(latency_text.data(), latency_text.size());
+    out.append(" user=");
+    out.append(user);
+  });
+
+  run("append_int + append_float", [&](Counted &out, int id, double latency) {
+    out.append("id=");
+    append_int(out, id);
+    out.append(" latency=");
+    append_float(out, latency);
+    out.append(" user=");
+    out.append(user);
+  });
+
+#ifdef STRING_FORMAT_ENABLED
+  run("format into std::string", [&](Counted &out, int id, double latency) {
+    std::string text = string_format::format_lib::format(
+        "id={} latency={} user={}", id, latency, std::string_view(user));
+    out.append(text.data(), text.size());
+  });
+
+  run("append_format", [&](Counted &out, int id, double latency) {
+    append_format(out, "id={} latency={} user={}", id, latency, user);
+  });
+#else
+  std::printf("no <format> or {fmt}; format rows skipped\n");
+#endif
+}
@@ -0,0 +1,96 @@
+#include "BasicString.hpp"
+#include "GermanString.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Sorting a column of strings, then joining it against a second column by
+// merging the sorted columns and by probing a hash set, with GermanString
+// and with BasicString. Most keys are longer than both inline buffers, so
+// BasicString compares through the heap every time while GermanString
+// settles most comparisons on the inline prefix. A second run gives every
+// key the same eight-character prefix, where the prefix cannot help.
+
+namespace {
+
+constexpr size_t count = 1 << 20;
+
+std::vector<std::string> make_keys(uint64_t seed, const std::string &lead) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::string> keys(count);
+  for (std::string &key : keys) {
+    key = lead;
+    size_t len = 16 + rng() % 24;
+    while (key.size() < len)
+      key.push_back(static_cast<char>('a' + rng() % 26));
+  }
+  return keys;
+}
+
+void report(const char *label, const char *step, const Timer &timer) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s %s", label, step);
+  std::printf("%-36s %10.2f ms\n", name, timer.elapsed_ms());
+}
+
+template <typename Key>
+void run(const char *label, const std::vector<std::string> &left,
+         const std::vector<std::string> &right) {
+  std::vector<Key> build;
+  std::vector<Key> probe;
+  for (const std::string &key : left)
+    build.emplace_back(std::string_view(key));
+  for (const std::string &key : right)
+    probe.emplace_back(std::string_view(key));
+  Timer sort_timer;
+  std::sort(build.begin(), build.end());
+  std::sort(probe.begin(), probe.end());
+  report(label, "sort", sort_timer);
+
+  Timer merge_timer;
+  size_t matches = 0;
+  for (auto l = build.begin(), r = probe.begin();
+       l != build.end() && r != probe.end();) {
+    int order = l->compare(*r);
+    if (order < 0) {
+      ++l;
+    } else if (order > 0) {
+      ++r;
+    } else {
+      ++matches;
+      ++l;
+      ++r;
+    }
+  }
+  do_not_optimize(matches);
+  report(label, "merge join", merge_timer);
+
+  std::unordered_set<Key> table(build.begin(), build.end());
+  Timer hash_timer;
+  matches = 0;
+  for (const Key &key : probe)
+    matches += table.count(key);
+  do_not_optimize(matches);
+  report(label, "hash join", hash_timer);
+}
+
+} // namespace
+
+int main() {
+  // Half of the probe keys also appear on the build side.
+  std::vector<std::string> left = make_keys(1, "");
+  std::vector<std::string> right = make_keys(2, "");
+  std::copy(left.begin(), left.begin() + count / 2, right.begin());
+  run<GermanString<char>>("GermanString", left, right);
+  run<BasicString<char>>("BasicString", left, right);
+
+  left = make_keys(3, "tenant42");
+  right = make_keys(4, "tenant42");
+  std::copy(left.begin(), left.begin() + count / 2, right.begin());
+  run<GermanString<char>>("GermanString shared prefix", left, right);
+  run<BasicString<char>>("BasicString shared prefix", left, right);
+}
@@ -0,0 +1,50 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <sstream>
+#include <string>
+
+// Reads a log-like text line by line into one reused string and reports
+// time and heap allocations per implementation.
+
+namespace {
+
+using CountedString =
+    BasicString<char, std::char_traits<char>, CountingAllocator<char>>;
+using CountedStdString =
+    std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+constexpr int lines = 500000;
+
+std::string make_text() {
+  std::string text;
+  for (int i = 0; i < lines; ++i) {
+    text += "2024-05-01T12:00:00Z INFO request id=";
+    text += std::to_string(i);
+    text.append(static_cast<size_t>(i % 97), 'x');
+    text += '\n';
+  }
+  return text;
+}
+
+template <typename String> void run(const char *name, const std::string &text) {
+  std::istringstream in(text);
+  AllocationStats::reset();
+  Timer timer;
+
+  String line;
+  size_t total = 0;
+  while (getline(in, line))
+    total += line.size();
+  do_not_optimize(total);
+
+  print_row(name, timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  std::string text = make_text();
+  run<CountedString>("BasicString getline", text);
+  run<CountedStdString>("std::string getline", text);
+}
@@ -0,0 +1,75 @@
+#include "BasicString.hpp"
+#include "HashedString.hpp"
+#include "bench_common.hpp"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Hash throughput for short and long keys, and unordered_set growth with
+// plain versus cached-hash keys: every rehash during growth hashes every
+// BasicString key again, while HashedString keys reuse their stored value.
+
+namespace {
+
+constexpr int rounds = 20;
+
+std::vector<BasicString<char>> make_keys(size_t count, size_t length) {
+  std::vector<BasicString<char>> keys;
+  for (size_t i = 0; i < count; ++i) {
+    std::string key = "service.requests.latency." + std::to_string(i);
+    key.resize(length, '#');
+    keys.emplace_back(key.c_str());
+  }
+  return keys;
+}
+
+template <typename Hash>
+void hash_throughput(const char *name,
+                     const std::vector<BasicString<char>> &keys, Hash hash) {
+  Timer timer;
+  size_t acc = 0;
+  size_t bytes = 0;
+  for (int r = 0; r < rounds; ++r) {
+    for (const BasicString<char> &key : keys) {
+      acc ^= hash(std::string_view(key));
+      bytes += key.size();
+    }
+  }
+  do_not_optimize(acc);
+  double ms = timer.elapsed_ms();
+  std::printf("%-40s %10.2f ms %8.2f GB/s\n", name, ms, bytes / ms / 1e6);
+}
+
+template <typename Key>
+void table_growth(const char *name,
+                  const std::vector<BasicString<char>> &keys) {
+  std::vector<Key> prepared(keys.begin(), keys.end());
+  Timer timer;
+  for (int r = 0; r < rounds; ++r) {
+    std::unordered_set<Key, BasicStringHash<char>, BasicStringEqual<char>> set;
+    for (const Key &key : prepared)
+      set.insert(key);
+    do_not_optimize(set.size());
+  }
+  std::printf("%-40s %10.2f ms\n", name, timer.elapsed_ms());
+}
+
+} // namespace
+
+int main() {
+  for (size_t length : {8, 24, 64, 256}) {
+    auto keys = make_keys(20000, length);
+    std::printf("key length %zu\n", length);
+    hash_throughput("  BasicStringHash", keys, BasicStringHash<char>());
+    hash_throughput("  std::hash<std::string_view>", keys,
+                    std::hash<std::string_view>());
+  }
+
+  auto keys = make_keys(100000, 128);
+  std::printf("unordered_set growth, 100000 keys of 128 chars\n");
+  table_growth<BasicString<char>>("  BasicString keys", keys);
+  table_growth<HashedString<char>>("  HashedString keys", keys);
+}
@@ -0,0 +1,81 @@
+#include "BasicString.hpp"
+#include "InplaceString.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+// Fixed-width keys held as InplaceString and as BasicString: building a
+// vector of them, copying it, sorting it and looking each key up in a hash
+// set. Tickers fit BasicString's inline buffer; the 28-character IDs do
+// not, so every BasicString copy of one allocates.
+
+namespace {
+
+using Counted = BasicString<char, std::char_traits<char>,
+                            CountingAllocator<char>>;
+
+constexpr size_t count = 1 << 20;
+
+std::vector<std::string> make_keys(size_t width) {
+  std::mt19937_64 rng(7);
+  std::vector<std::string> keys(count);
+  for (std::string &key : keys) {
+    key.resize(width);
+    for (char &ch : key)
+      ch = static_cast<char>('A' + rng() % 26);
+  }
+  return keys;
+}
+
+template <typename Key>
+void run(const char *label, const std::vector<std::string> &source) {
+  char name[64];
+
+  AllocationStats::reset();
+  Timer build_timer;
+  std::vector<Key> keys;
+  keys.reserve(source.size());
+  for (const std::string &key : source)
+    keys.emplace_back(std::string_view(key));
+  std::snprintf(name, sizeof(name), "%s build", label);
+  print_row(name, build_timer.elapsed_ms(), AllocationStats::allocations);
+
+  AllocationStats::reset();
+  Timer copy_timer;
+  std::vector<Key> copy = keys;
+  do_not_optimize(copy.data());
+  std::snprintf(name, sizeof(name), "%s copy", label);
+  print_row(name, copy_timer.elapsed_ms(), AllocationStats::allocations);
+
+  AllocationStats::reset();
+  Timer sort_timer;
+  std::sort(copy.begin(), copy.end());
+  std::snprintf(name, sizeof(name), "%s sort", label);
+  print_row(name, sort_timer.elapsed_ms(), AllocationStats::allocations);
+
+  std::unordered_set<Key, BasicStringHash<char>, BasicStringEqual<char>> set(
+      keys.begin(), keys.end());
+  AllocationStats::reset();
+  Timer lookup_timer;
+  size_t hits = 0;
+  for (const std::string &key : source)
+    hits += set.count(std::string_view(key));
+  do_not_optimize(hits);
+  std::snprintf(name, sizeof(name), "%s lookup", label);
+  print_row(name, lookup_timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> tickers = make_keys(6);
+  run<InplaceString<8>>("ticker InplaceString<8>", tickers);
+  run<Counted>("ticker BasicString", tickers);
+
+  std::vector<std::string> ids = make_keys(28);
+  run<InplaceString<31>>("id InplaceString<31>", ids);
+  run<Counted>("id BasicString", ids);
+}
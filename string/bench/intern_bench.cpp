@@ -0,0 +1,73 @@
+#include "BasicString.hpp"
+#include "InternPool.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Metric names repeat far more often than they are new. Every worker turns
+// a stream of names into symbols (mostly hits on the lock-free path) and
+// counts them in a table keyed by symbol, against the same counting keyed
+// by BasicString, where every lookup hashes and compares characters.
+
+namespace {
+
+constexpr int workers = 8;
+constexpr size_t distinct = 20000;
+constexpr size_t lookups_per_worker = 2000000;
+
+std::vector<std::string> make_names() {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < distinct; ++i)
+    names.push_back("service.http.server.requests.total{route=/api/v1/item/" +
+                    std::to_string(i) + "}");
+  return names;
+}
+
+template <typename Work> void run(const char *name, Work work) {
+  Timer timer;
+  std::vector<std::thread> threads;
+  for (int w = 0; w < workers; ++w)
+    threads.emplace_back(work, w);
+  for (std::thread &thread : threads)
+    thread.join();
+  std::printf("%-40s %10.2f ms\n", name, timer.elapsed_ms());
+}
+
+} // namespace
+
+int main() {
+  const std::vector<std::string> names = make_names();
+
+  InternPool pool;
+  run("intern from all threads", [&](int w) {
+    size_t acc = 0;
+    for (size_t i = 0; i < lookups_per_worker; ++i)
+      acc += pool.intern(names[(i * 7919 + w) % distinct]).size();
+    do_not_optimize(acc);
+  });
+
+  std::vector<Symbol<char>> symbols;
+  std::vector<BasicString<char>> strings;
+  for (const std::string &name : names) {
+    symbols.push_back(pool.intern(name));
+    strings.emplace_back(name.c_str());
+  }
+
+  run("count by BasicString key", [&](int w) {
+    std::unordered_map<BasicString<char>, size_t> counts;
+    for (size_t i = 0; i < lookups_per_worker; ++i)
+      ++counts[strings[(i * 7919 + w) % distinct]];
+    do_not_optimize(counts.size());
+  });
+
+  run("count by Symbol key", [&](int w) {
+    std::unordered_map<Symbol<char>, size_t> counts;
+    for (size_t i = 0; i < lookups_per_worker; ++i)
+      ++counts[symbols[(i * 7919 + w) % distinct]];
+    do_not_optimize(counts.size());
+  });
+}
@@ -0,0 +1,53 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+
+// Stripping characters from a large string: erase(pos, 1) after every find
+// moves the tail each time, so the loop is quadratic; erase() and
+// erase_if() compact in one pass.
+
+namespace {
+
+constexpr size_t length = 1 << 18;
+constexpr int rounds = 5;
+
+BasicString<char> make_text() {
+  BasicString<char> text;
+  while (text.size() < length)
+    text.append("key = value, other_key = other value; ");
+  return text;
+}
+
+template <typename Op> void run(const char *name, Op op) {
+  Timer timer;
+  for (int r = 0; r < rounds; ++r)
+    op();
+  std::printf("%-36s %10.2f ms\n", name, timer.elapsed_ms());
+}
+
+} // namespace
+
+int main() {
+  const BasicString<char> source = make_text();
+
+  run("find + erase(pos, 1)", [&] {
+    BasicString<char> text = source;
+    size_t pos = 0;
+    while ((pos = text.find(' ', pos)) != BasicString<char>::npos)
+      text.erase(pos, 1);
+    do_not_optimize(text.size());
+  });
+
+  run("erase(str, ' ')", [&] {
+    BasicString<char> text = source;
+    erase(text, ' ');
+    do_not_optimize(text.size());
+  });
+
+  run("erase_if(str, separator)", [&] {
+    BasicString<char> text = source;
+    erase_if(text, [](char ch) { return ch == ' ' || ch == ';'; });
+    do_not_optimize(text.size());
+  });
+}
@@ -0,0 +1,68 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <cstring>
+#include <vector>
+
+// Fills a string from a read()-like source in 64 KiB pieces. resize()
+// zero-fills every byte before the copy overwrites it; resize_and_overwrite
+// and reserve_append/commit_append hand out the uninitialized tail, so the
+// bytes are written once.
+
+namespace {
+
+constexpr size_t total = 64 * 1024 * 1024;
+constexpr size_t piece = 64 * 1024;
+constexpr int rounds = 10;
+
+// Stand-in for read(2): copies up to count bytes and reports how many.
+size_t fake_read(const std::vector<char> &source, size_t offset, char *out,
+                 size_t count) {
+  size_t n = std::min(count, source.size() - offset);
+  std::memcpy(out, source.data() + offset, n);
+  return n;
+}
+
+template <typename Fill> void run(const char *name, Fill fill) {
+  std::vector<char> source(total, 's');
+  // One buffer reused across rounds, so page faults are not measured.
+  BasicString<char> str;
+  str.reserve(total);
+  Timer timer;
+  for (int r = 0; r < rounds; ++r) {
+    str.clear();
+    for (size_t offset = 0; offset < total; offset += piece)
+      fill(str, source, offset);
+    do_not_optimize(str.size());
+  }
+  std::printf("%-36s %10.2f ms\n", name, timer.elapsed_ms());
+}
+
+} // namespace
+
+int main() {
+  run("resize + copy",
+      [](BasicString<char> &str, const std::vector<char> &source,
+         size_t offset) {
+        size_t len = str.size();
+        str.resize(len + piece, '\0');
+        size_t got = fake_read(source, offset, &str[len], piece);
+        str.resize(len + got, '\0');
+      });
+
+  run("resize_and_overwrite",
+      [](BasicString<char> &str, const std::vector<char> &source,
+         size_t offset) {
+        size_t len = str.size();
+        str.resize_and_overwrite(len + piece, [&](char *data, size_t) {
+          return len + fake_read(source, offset, data + len, piece);
+        });
+      });
+
+  run("reserve_append + commit_append",
+      [](BasicString<char> &str, const std::vector<char> &source,
+         size_t offset) {
+        char *out = str.reserve_append(piece);
+        str.commit_append(fake_read(source, offset, out, piece));
+      });
+}
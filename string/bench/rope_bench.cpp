@@ -0,0 +1,72 @@
+#include "BasicString.hpp"
+#include "Rope.hpp"
+#include "bench_common.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+// Editor-style workload on a multi-megabyte document: many small inserts
+// and erases at pseudo-random positions. BasicString moves the tail on
+// every edit; the rope rewrites one leaf and the path above it.
+
+namespace {
+
+constexpr size_t document_size = 8 * 1024 * 1024;
+constexpr int edits = 20000;
+
+struct Lcg {
+  uint64_t state = 42;
+  size_t next(size_t bound) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<size_t>(state >> 33) % bound;
+  }
+};
+
+void edit(Rope<char> &text) {
+  Lcg rng;
+  for (int i = 0; i < edits; ++i) {
+    size_t pos = rng.next(text.size());
+    if (i % 2 == 0) {
+      text.replace(pos, 0, std::string_view("inserted text "));
+    } else {
+      text.erase(pos, 12);
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  BasicString<char> document(document_size, 'd');
+
+  {
+    BasicString<char> text = document;
+    Timer timer;
+    Lcg rng;
+    BasicString<char> insert("inserted text ");
+    for (int i = 0; i < edits; ++i) {
+      size_t pos = rng.next(text.size());
+      if (i % 2 == 0) {
+        text.replace(pos, 0, insert);
+      } else {
+        text.erase(pos, 12);
+      }
+    }
+    do_not_optimize(text.size());
+    std::printf("%-36s %10.2f ms\n", "BasicString replace/erase",
+                timer.elapsed_ms());
+  }
+
+  {
+    Rope<char> text(document);
+    Timer timer;
+    edit(text);
+    do_not_optimize(text.size());
+    std::printf("%-36s %10.2f ms\n", "Rope insert/erase", timer.elapsed_ms());
+
+    Timer flatten;
+    BasicString<char> flat = text.flatten();
+    do_not_optimize(flat.size());
+    std::printf("%-36s %10.2f ms\n", "Rope flatten", flatten.elapsed_ms());
+  }
+}
@@ -0,0 +1,99 @@
+#include "BasicString.hpp"
+#include "Searchers.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+#include <vector>
+
+// Throughput of the precompiled searchers. Aho-Corasick is run with a
+// growing number of patterns and compared with one BasicString::find pass
+// per pattern; Horspool is compared with find for a single long needle.
+
+namespace {
+
+constexpr int passes = 5;
+
+BasicString<char> make_text() {
+  BasicString<char> text;
+  unsigned state = 42;
+  for (int i = 0; i < 80000; ++i) {
+    state = state * 1664525 + 1013904223;
+    text += "ts=1714564800 level=info svc=api-";
+    text += std::to_string(state % 64).c_str();
+    text += " msg=\"request handled\" user=u";
+    text += std::to_string(state % 100000).c_str();
+    text += '\n';
+  }
+  return text;
+}
+
+void report(const char *name, double ms, size_t bytes, size_t matches) {
+  std::printf("%-40s %10.2f ms %8.2f MB/s %10zu matches\n", name, ms,
+              bytes * passes / ms / 1e3, matches);
+}
+
+} // namespace
+
+int main() {
+  BasicString<char> text = make_text();
+
+  for (size_t count : {1, 10, 100, 1000}) {
+    std::vector<BasicString<char>> patterns;
+    for (size_t i = 0; i < count; ++i) {
+      patterns.push_back(("user=u" + std::to_string(i * 97 % 100000)).c_str());
+    }
+
+    std::printf("%zu patterns\n", count);
+    AhoCorasickSearcher<char> automaton(patterns);
+
+    Timer ac_timer;
+    size_t matches = 0;
+    for (int p = 0; p < passes; ++p) {
+      automaton.for_each_match(text, [&](const auto &) { ++matches; });
+    }
+    report("  AhoCorasickSearcher", ac_timer.elapsed_ms(), text.size(),
+           matches / passes);
+
+    if (count > 100)
+      continue;
+
+    Timer find_timer;
+    matches = 0;
+    for (int p = 0; p < passes; ++p) {
+      for (const BasicString<char> &pattern : patterns) {
+        for (size_t pos = text.find(pattern); pos != BasicString<char>::npos;
+             pos = text.find(pattern, pos + 1)) {
+          ++matches;
+        }
+      }
+    }
+    report("  find per pattern", find_timer.elapsed_ms(), text.size(),
+           matches / passes);
+  }
+
+  const char *needle = "msg=\"request handled\" user=u99999\n";
+  std::printf("single needle, length %zu\n", std::strlen(needle));
+
+  HorspoolSearcher<char> horspool(needle);
+  Timer bmh_timer;
+  size_t found = 0;
+  for (int p = 0; p < passes; ++p) {
+    for (size_t pos = horspool.find(text); pos != HorspoolSearcher<char>::npos;
+         pos = horspool.find(text, pos + 1)) {
+      ++found;
+    }
+  }
+  report("  HorspoolSearcher", bmh_timer.elapsed_ms(), text.size(),
+         found / passes);
+
+  Timer find_timer;
+  found = 0;
+  for (int p = 0; p < passes; ++p) {
+    for (size_t pos = text.find(needle); pos != BasicString<char>::npos;
+         pos = text.find(needle, pos + 1)) {
+      ++found;
+    }
+  }
+  report("  BasicString::find", find_timer.elapsed_ms(), text.size(),
+         found / passes);
+}
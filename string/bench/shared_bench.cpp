@@ -0,0 +1,68 @@
+#include "BasicString.hpp"
+#include "SharedString.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+// A routing table handed to every worker thread: each worker takes its own
+// copy of the table many times over. BasicString copies allocate and copy
+// every value; SharedString copies bump a reference count.
+
+namespace {
+
+using CountedString =
+    BasicString<char, std::char_traits<char>, CountingAllocator<char>>;
+using CountedShared =
+    SharedString<char, std::char_traits<char>, CountingAllocator<char>>;
+
+constexpr int workers = 8;
+constexpr int copies_per_worker = 200;
+constexpr size_t table_size = 2000;
+
+template <typename String> std::vector<String> make_table() {
+  std::vector<String> table;
+  for (size_t i = 0; i < table_size; ++i) {
+    std::string value =
+        "cluster-" + std::to_string(i % 17) + ".upstream.service.internal:" +
+        std::to_string(8000 + i);
+    table.emplace_back(value.c_str());
+  }
+  return table;
+}
+
+template <typename String> void run(const char *name) {
+  const std::vector<String> table = make_table<String>();
+
+  // The allocation counters are not atomic, so count one copy of the table
+  // on this thread before the workers start.
+  AllocationStats::reset();
+  {
+    std::vector<String> local(table.begin(), table.end());
+    do_not_optimize(local.back().size());
+  }
+  size_t allocations = AllocationStats::allocations;
+
+  Timer timer;
+  std::vector<std::thread> threads;
+  for (int w = 0; w < workers; ++w) {
+    threads.emplace_back([&table] {
+      for (int c = 0; c < copies_per_worker; ++c) {
+        std::vector<String> local(table.begin(), table.end());
+        do_not_optimize(local.back().size());
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  std::printf("%-36s %10.2f ms %8zu allocations per table copy\n", name,
+              timer.elapsed_ms(), allocations);
+}
+
+} // namespace
+
+int main() {
+  run<CountedString>("BasicString table copies");
+  run<CountedShared>("SharedString table copies");
+}
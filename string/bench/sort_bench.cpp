@@ -0,0 +1,59 @@
+#include "BasicString.hpp"
+#include "StringSort.hpp"
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// Sorting log keys (timestamp, host, service, request id) that share long
+// prefixes: std::sort over BasicString against sort_strings on one thread
+// and on every hardware thread.
+
+namespace {
+
+constexpr size_t count = 1 << 22;
+
+std::vector<BasicString<char>> make_keys() {
+  std::mt19937_64 rng(5);
+  std::vector<BasicString<char>> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    char key[96];
+    std::snprintf(key, sizeof(key),
+                  "2026-10-17T%02u:%02u:%02u.%03uZ host-%03u svc-%u req-%llx",
+                  static_cast<unsigned>(rng() % 24),
+                  static_cast<unsigned>(rng() % 60),
+                  static_cast<unsigned>(rng() % 60),
+                  static_cast<unsigned>(rng() % 1000),
+                  static_cast<unsigned>(rng() % 200),
+                  static_cast<unsigned>(rng() % 16),
+                  static_cast<unsigned long long>(rng()));
+    keys.emplace_back(key);
+  }
+  return keys;
+}
+
+template <typename Sort>
+void run(const char *name, const std::vector<BasicString<char>> &source,
+         Sort sort) {
+  std::vector<BasicString<char>> keys = source;
+  Timer timer;
+  sort(keys);
+  std::printf("%-36s %10.2f ms\n", name, timer.elapsed_ms());
+  if (!std::is_sorted(keys.begin(), keys.end()))
+    std::printf("  not sorted!\n");
+}
+
+} // namespace
+
+int main() {
+  const std::vector<BasicString<char>> keys = make_keys();
+
+  run("std::sort", keys,
+      [](auto &v) { std::sort(v.begin(), v.end()); });
+  run("sort_strings", keys, [](auto &v) { sort_strings(v); });
+  run("sort_strings, all threads", keys,
+      [](auto &v) { sort_strings(v, 0); });
+}
@@ -0,0 +1,92 @@
+#include "StringSplit.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+
+// Splitting CSV rows into fields: the find + substring-constructor loop
+// allocates a string per long field, split() hands out views. Tokenizing
+// log lines compares the vector byte-set scan with the bitmap scan.
+
+namespace {
+
+using Counted = BasicString<char, std::char_traits<char>,
+                            CountingAllocator<char>>;
+
+constexpr int rows = 200000;
+constexpr int rounds = 5;
+
+template <typename Op> void run(const char *name, Op op) {
+  AllocationStats::reset();
+  Timer timer;
+  for (int r = 0; r < rounds; ++r)
+    op();
+  print_row(name, timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  Counted csv;
+  for (int i = 0; i < rows; ++i) {
+    csv.append("1042,2024-03-01T12:00:00Z,customer-account-identifier,");
+    csv.append("some free text description of the order,19.99\n");
+  }
+
+  run("find + substr per field", [&] {
+    size_t total = 0;
+    size_t start = 0;
+    while (start < csv.size()) {
+      size_t stop = csv.find('\n', start);
+      Counted line(csv, start, stop - start);
+      size_t pos = 0;
+      for (;;) {
+        size_t comma = line.find(',', pos);
+        Counted field(line, pos,
+                      comma == Counted::npos ? Counted::npos : comma - pos);
+        total += field.size();
+        if (comma == Counted::npos)
+          break;
+        pos = comma + 1;
+      }
+      start = stop + 1;
+    }
+    do_not_optimize(total);
+  });
+
+  run("split into views", [&] {
+    size_t total = 0;
+    for (std::string_view line : split(csv, '\n')) {
+      for (std::string_view field : split(line, ','))
+        total += field.size();
+    }
+    do_not_optimize(total);
+  });
+
+  std::string log;
+  for (int i = 0; i < rows; ++i)
+    log += "2024-03-01 12:00:00.123 INFO  [worker-17] request handled in "
+           "12ms path=/api/v1/orders status=200\n";
+  std::string_view separators = " \t[]=\n";
+  string_search::byte_set set(separators.data(), separators.size());
+
+  run("tokenize (bitmap scan)", [&] {
+    size_t tokens = 0;
+    size_t pos = 0;
+    while (pos < log.size()) {
+      size_t found = string_search::find_any_scalar(log.data(), log.size(),
+                                                    set, pos);
+      if (found == string_search::npos)
+        break;
+      tokens += found > pos;
+      pos = found + 1;
+    }
+    do_not_optimize(tokens);
+  });
+
+  run("tokenize (dispatched scan)", [&] {
+    size_t tokens = 0;
+    for (std::string_view token : tokenize(std::string_view(log), separators))
+      tokens += !token.empty();
+    do_not_optimize(tokens);
+  });
+}
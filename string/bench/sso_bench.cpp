@@ -0,0 +1,66 @@
+#include "BasicString.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+#include <vector>
+
+// Short-string workload: header names and identifiers that fit in the inline
+// buffer are constructed, copied, extended and edited. The long workload runs
+// the same operations on strings that have to live on the heap.
+
+namespace {
+
+using CountedString =
+    BasicString<char, std::char_traits<char>, CountingAllocator<char>>;
+using CountedStdString =
+    std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+const char *const short_keys[] = {
+    "host",       "accept",        "user-agent",   "content-type",
+    "cookie",     "x-request-id",  "etag",         "cache-control",
+    "connection", "authorization", "content-length", "if-none-match",
+};
+
+const char *const long_keys[] = {
+    "x-forwarded-for-original-client-address",
+    "strict-transport-security-max-age-directive",
+    "access-control-allow-credentials-header-value",
+    "content-security-policy-report-only-endpoint",
+};
+
+constexpr int iterations = 200000;
+
+template <typename String, size_t N>
+void run(const char *name, const char *const (&keys)[N]) {
+  AllocationStats::reset();
+  Timer timer;
+
+  std::vector<String> table;
+  table.reserve(N);
+  for (int i = 0; i < iterations; ++i) {
+    String key(keys[i % N]);
+    String copy(key);
+    copy.push_back(':');
+    copy.resize(copy.size() + 1, ' ');
+    copy.erase(0, 1);
+    do_not_optimize(copy.size());
+
+    if (table.size() < N) {
+      table.push_back(copy);
+    } else {
+      using std::swap;
+      swap(table[i % N], key);
+    }
+  }
+
+  print_row(name, timer.elapsed_ms(), AllocationStats::allocations);
+}
+
+} // namespace
+
+int main() {
+  run<CountedString>("BasicString, short keys", short_keys);
+  run<CountedStdString>("std::string, short keys", short_keys);
+  run<CountedString>("BasicString, long keys", long_keys);
+  run<CountedStdString>("std::string, long keys", long_keys);
+}
@@ -0,0 +1,102 @@
+#include "BasicString.hpp"
+#include "StringTable.hpp"
+#include "bench_common.hpp"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Holding a column of short strings: a vector of BasicString against a
+// StringTable and a DictionaryStringTable, counting heap bytes through
+// CountingAllocator, then scanning every string. The table is also written
+// to a file and mapped back.
+
+namespace {
+
+using Counted = BasicString<char, std::char_traits<char>,
+                            CountingAllocator<char>>;
+
+constexpr size_t count = 4 << 20;
+
+// Hostnames with a few hundred distinct values, most longer than the inline
+// buffer.
+std::vector<std::string> make_column() {
+  std::mt19937_64 rng(11);
+  std::vector<std::string> column(count);
+  for (std::string &value : column)
+    value = "node-" + std::to_string(rng() % 500) + ".cluster.example.net";
+  return column;
+}
+
+void row(const char *name, double ms, size_t bytes) {
+  std::printf("%-36s %10.2f ms %12.1f MiB\n", name, ms,
+              static_cast<double>(bytes) / (1 << 20));
+}
+
+template <typename Column> size_t scan(const Column &column) {
+  size_t total = 0;
+  for (size_t i = 0; i < column.size(); ++i)
+    total += std::string_view(column[i]).size();
+  return total;
+}
+
+} // namespace
+
+int main() {
+  const std::vector<std::string> source = make_column();
+
+  {
+    AllocationStats::reset();
+    Timer timer;
+    std::vector<Counted, CountingAllocator<Counted>> strings;
+    for (const std::string &value : source)
+      strings.emplace_back(std::string_view(value));
+    row("vector<BasicString> build", timer.elapsed_ms(),
+        AllocationStats::bytes);
+    Timer scan_timer;
+    do_not_optimize(scan(strings));
+    row("vector<BasicString> scan", scan_timer.elapsed_ms(), 0);
+  }
+
+  BasicStringTable<char, std::char_traits<char>, CountingAllocator<char>>
+      table;
+  {
+    AllocationStats::reset();
+    Timer timer;
+    table.append(source);
+    row("StringTable build", timer.elapsed_ms(), AllocationStats::bytes);
+    Timer scan_timer;
+    do_not_optimize(scan(table));
+    row("StringTable scan", scan_timer.elapsed_ms(), 0);
+  }
+
+  {
+    AllocationStats::reset();
+    Timer timer;
+    BasicDictionaryStringTable<char, std::char_traits<char>,
+                               CountingAllocator<char>>
+        column;
+    column.append(source);
+    row("DictionaryStringTable build", timer.elapsed_ms(),
+        AllocationStats::bytes);
+    Timer scan_timer;
+    do_not_optimize(scan(column));
+    row("DictionaryStringTable scan", scan_timer.elapsed_ms(), 0);
+  }
+
+#ifdef STRING_TABLE_MMAP
+  const char *path = "table_bench.bin";
+  Timer write_timer;
+  table.write(path);
+  row("StringTable write", write_timer.elapsed_ms(), 0);
+
+  Timer map_timer;
+  MappedStringTable mapped(path);
+  row("MappedStringTable open", map_timer.elapsed_ms(), 0);
+  Timer scan_timer;
+  do_not_optimize(scan(mapped));
+  row("MappedStringTable scan", scan_timer.elapsed_ms(), 0);
+  std::remove(path);
+#endif
+}
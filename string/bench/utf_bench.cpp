@@ -0,0 +1,66 @@
+#include "StringUtf.hpp"
+#include "Transcode.hpp"
+#include "bench_common.hpp"
+
+#include <string>
+
+// UTF-8 validation and transcoding throughput on a mostly-ASCII corpus
+// (source code and English prose with the odd accent) and a CJK corpus
+// where nearly every character is three bytes. The scalar validator is
+// the baseline for the vector one.
+
+namespace {
+
+constexpr size_t corpus_size = 16 * 1024 * 1024;
+constexpr int rounds = 10;
+
+std::string build_corpus(const char *piece) {
+  std::string text;
+  while (text.size() < corpus_size)
+    text += piece;
+  return text;
+}
+
+template <typename Op>
+void run(const char *name, const std::string &corpus, Op op) {
+  Timer timer;
+  for (int r = 0; r < rounds; ++r)
+    op(corpus);
+  double ms = timer.elapsed_ms();
+  double gb_per_s = static_cast<double>(corpus.size()) * rounds / ms / 1e6;
+  std::printf("%-36s %10.2f ms %8.2f GB/s\n", name, ms, gb_per_s);
+}
+
+void run_corpus(const char *label, const std::string &corpus) {
+  std::printf("%s\n", label);
+  run("validate (scalar)", corpus, [](const std::string &text) {
+    do_not_optimize(
+        string_utf::validate_utf8_scalar(text.data(), text.size()));
+  });
+  run("validate (dispatched)", corpus, [](const std::string &text) {
+    do_not_optimize(is_valid_utf8(text));
+  });
+  run("to_utf16", corpus, [](const std::string &text) {
+    do_not_optimize(to_utf16(text).size());
+  });
+  run("to_utf32", corpus, [](const std::string &text) {
+    do_not_optimize(to_utf32(text).size());
+  });
+
+  BasicString<char16_t> utf16 = to_utf16(corpus);
+  run("to_utf8 from UTF-16", corpus, [&](const std::string &) {
+    do_not_optimize(to_utf8(std::u16string_view(utf16)).size());
+  });
+}
+
+} // namespace
+
+int main() {
+  run_corpus("ASCII-heavy corpus",
+             build_corpus("for (size_t i = 0; i < n; ++i) total += v[i]; "
+                          "// the caf\xC3\xA9 opens at nine\n"));
+  run_corpus("CJK-heavy corpus",
+             build_corpus("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE"
+                          "\xE6\x96\x87\xE7\xAB\xA0\xE3\x81\xA7\xE3\x81\x99"
+                          "\xE3\x80\x82 "));
+}
@@ -0,0 +1,179 @@
+#ifndef ARENA_RESOURCE_H
+#define ARENA_RESOURCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Monotonic memory resource for request-scoped strings. Allocations bump a
+// pointer through blocks obtained from the upstream resource and
+// deallocate() does nothing; memory comes back all at once through reset(),
+// which keeps the blocks for the next request, or release(), which returns
+// them upstream. Not thread-safe: give each request or thread its own arena.
+class ArenaResource : public std::pmr::memory_resource {
+public:
+  static constexpr size_t default_block_size = 4096;
+  // Block sizes double up to this; larger requests still get a block of
+  // their own size, and a larger block_size passed in is kept.
+  static constexpr size_t max_block_size = size_t(1) << 20;
+
+  explicit ArenaResource(
+      size_t block_size = default_block_size,
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+  ArenaResource(const ArenaResource &) = delete;
+  ArenaResource &operator=(const ArenaResource &) = delete;
+  ~ArenaResource() override;
+
+  // Makes all memory handed out so far available again without touching
+  // the upstream resource.
+  void reset() noexcept;
+  // Returns every block to the upstream resource.
+  void release() noexcept;
+
+  size_t bytes_allocated() const noexcept;
+  size_t block_count() const noexcept;
+  std::pmr::memory_resource *upstream_resource() const noexcept;
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override;
+
+private:
+  // Header at the start of every block; blocks are kept in the order they
+  // were obtained so reset() can walk them again.
+  struct Block {
+    Block *next;
+    size_t size;
+  };
+
+  static std::byte *block_begin(Block *block) noexcept;
+  static std::byte *block_end(Block *block) noexcept;
+  static std::byte *align_up(std::byte *p, size_t alignment) noexcept;
+  void enter(Block *block) noexcept;
+
+  std::pmr::memory_resource *upstream_;
+  size_t block_size_;
+  Block *head_ = nullptr;
+  Block *current_ = nullptr;
+  std::byte *cursor_ = nullptr;
+  std::byte *limit_ = nullptr;
+  size_t used_before_current_ = 0;
+  size_t block_count_ = 0;
+};
+
+inline ArenaResource::ArenaResource(size_t block_size,
+                                    std::pmr::memory_resource *upstream)
+    : upstream_(upstream),
+      block_size_(block_size > sizeof(Block) ? block_size
+                                             : default_block_size) {}
+
+inline ArenaResource::~ArenaResource() { release(); }
+
+inline std::byte *ArenaResource::block_begin(Block *block) noexcept {
+  return reinterpret_cast<std::byte *>(block) + sizeof(Block);
+}
+
+inline std::byte *ArenaResource::block_end(Block *block) noexcept {
+  return reinterpret_cast<std::byte *>(block) + block->size;
+}
+
+inline std::byte *ArenaResource::align_up(std::byte *p,
+                                          size_t alignment) noexcept {
+  uintptr_t value = reinterpret_cast<uintptr_t>(p);
+  uintptr_t aligned = (value + alignment - 1) & ~(uintptr_t(alignment) - 1);
+  return p + (aligned - value);
+}
+
+inline void ArenaResource::enter(Block *block) noexcept {
+  if (current_ != nullptr)
+    used_before_current_ +=
+        static_cast<size_t>(cursor_ - block_begin(current_));
+  current_ = block;
+  cursor_ = block_begin(block);
+  limit_ = block_end(block);
+}
+
+inline void ArenaResource::reset() noexcept {
+  current_ = nullptr;
+  cursor_ = limit_ = nullptr;
+  used_before_current_ = 0;
+  if (head_ != nullptr)
+    enter(head_);
+}
+
+inline void ArenaResource::release() noexcept {
+  for (Block *block = head_; block != nullptr;) {
+    Block *next = block->next;
+    upstream_->deallocate(block, block->size, alignof(std::max_align_t));
+    block = next;
+  }
+  head_ = current_ = nullptr;
+  cursor_ = limit_ = nullptr;
+  used_before_current_ = 0;
+  block_count_ = 0;
+}
+
+inline size_t ArenaResource::bytes_allocated() const noexcept {
+  if (current_ == nullptr)
+    return 0;
+  return used_before_current_ +
+         static_cast<size_t>(cursor_ - block_begin(current_));
+}
+
+inline size_t ArenaResource::block_count() const noexcept {
+  return block_count_;
+}
+
+inline std::pmr::memory_resource *
+ArenaResource::upstream_resource() const noexcept {
+  return upstream_;
+}
+
+inline void *ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+  std::byte *p = align_up(cursor_, alignment);
+  if (current_ != nullptr && p <= limit_ &&
+      bytes <= static_cast<size_t>(limit_ - p)) {
+    cursor_ = p + bytes;
+    return p;
+  }
+
+  // Move on to the next retained block if the request fits there; a
+  // request that does not gets a fresh block spliced in after the current
+  // one, so retained blocks are never skipped for good.
+  Block *next = current_ != nullptr ? current_->next : head_;
+  size_t needed = sizeof(Block) + bytes + alignment;
+  if (next == nullptr || next->size < needed) {
+    size_t size = std::max(block_size_, needed);
+    Block *block = static_cast<Block *>(
+        upstream_->allocate(size, alignof(std::max_align_t)));
+    block->size = size;
+    block->next = next;
+    if (current_ != nullptr) {
+      current_->next = block;
+    } else {
+      head_ = block;
+    }
+    ++block_count_;
+    if (block_size_ < max_block_size)
+      block_size_ = std::min(block_size_ * 2, max_block_size);
+    next = block;
+  }
+
+  enter(next);
+  p = align_up(cursor_, alignment);
+  cursor_ = p + bytes;
+  return p;
+}
+
+inline void ArenaResource::do_deallocate(void *, size_t, size_t) {}
+
+inline bool
+ArenaResource::do_is_equal(const std::pmr::memory_resource &other) const
+    noexcept {
+  return this == &other;
+}
+
+#endif
@@ -2,15 +2,89 @@
 #define STRING_H
 
 #include <algorithm>
+#include <array>
+#include <concepts>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <stddef.h>
 #include <stdexcept>
 #include <string_view>
+#include <utility>
+
+#include "StringHash.hpp"
+#include "StringSearch.hpp"
+
+// Capacity to allocate when a BasicString has to grow past `current` to hold
+// at least `required` characters. Geometric growth keeps repeated appends
+// amortized O(1); specialize for a CharT/Allocator pair to tune the factor.
+template <typename CharT, typename Allocator> struct BasicStringGrowth {
+  static constexpr size_t factor_num = 2;
+  static constexpr size_t factor_den = 1;
+
+  template <typename SizeT>
+  static constexpr SizeT next_capacity(SizeT current, SizeT required) {
+    SizeT grown = current / factor_den * factor_num;
+    return grown > required ? grown : required;
+  }
+};
+
+// Lazy result of chaining operator+ over BasicString, string_view,
+// const CharT* and CharT operands. Only views of the pieces are recorded;
+// building a BasicString from it computes the total length once, allocates
+// once and copies every piece once. The pieces are not owned, so convert
+// the result to a BasicString in the statement that produced it:
+//
+//   BasicString<char> url = scheme + host + path;  // fine
+//   auto url = scheme + host + path;               // views of the operands
+//
+// An rvalue BasicString operand makes operator+ return a BasicString
+// instead, so temporaries never end up inside a StringConcat.
+template <typename CharT, typename Traits, size_t N> class StringConcat {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  constexpr explicit StringConcat(const std::array<view_type, N> &pieces)
+      : pieces_(pieces) {}
+  constexpr explicit StringConcat(view_type piece)
+    requires(N == 1)
+      : pieces_{piece} {}
+
+  constexpr size_t size() const {
+    size_t total = 0;
+    for (const view_type &piece : pieces_)
+      total += piece.size();
+    return total;
+  }
+
+  constexpr CharT *copy_to(CharT *out) const {
+    for (const view_type &piece : pieces_) {
+      Traits::copy(out, piece.data(), piece.size());
+      out += piece.size();
+    }
+    return out;
+  }
+
+  constexpr const std::array<view_type, N> &pieces() const { return pieces_; }
 
-// TODO: implement iterators, operator+ for string_view, const char*,
-// BasicString, optimize work with allocator(select, propagate), SSO
+private:
+  std::array<view_type, N> pieces_;
+};
+
+// Result type of BasicString's operator<=>: the traits' comparison_category
+// when it declares one, weak_ordering otherwise.
+template <typename Traits, typename = void> struct BasicStringOrdering {
+  using type = std::weak_ordering;
+};
+
+template <typename Traits>
+struct BasicStringOrdering<Traits,
+                           std::void_t<typename Traits::comparison_category>> {
+  using type = typename Traits::comparison_category;
+};
 
 template <typename CharT, typename Traits = std::char_traits<CharT>,
           typename Allocator = std::allocator<CharT>>
@@ -27,571 +101,1658 @@ public:
   using difference_type =
       typename std::allocator_traits<allocator_type>::difference_type;
   using traits_type = Traits;
+  using growth_policy = BasicStringGrowth<CharT, Allocator>;
+  // Plain pointers: contiguous iterators that the standard algorithms
+  // recognize and lower to memchr, memmove and friends.
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-  static const size_type npos = static_cast<size_type>(-1);
+  static constexpr size_type npos = static_cast<size_type>(-1);
 
 private:
-  pointer data_;
+  struct long_rep {
+    pointer data;
+    size_type capacity;
+  };
+
+  // Short strings are stored inline in a three-word buffer that overlaps the
+  // heap pointer and capacity. The top bit of size_ is set in heap mode.
+  static constexpr size_type local_capacity =
+      (sizeof(long_rep) + sizeof(size_type)) / sizeof(CharT) - 1;
+  static constexpr size_type long_flag = ~(static_cast<size_type>(-1) >> 1);
+
+  union rep {
+    CharT local[local_capacity + 1];
+    long_rep heap;
+  };
+
+  rep rep_;
   size_type size_;
-  size_type capacity_;
-  allocator_type allocator_;
+  [[no_unique_address]] allocator_type allocator_;
 
 public:
   /* constructor */
-  BasicString();
-  BasicString(const BasicString &);
-  BasicString(const BasicString &other, size_type pos, size_type len = npos);
-  BasicString(const CharT *);
-  BasicString(size_t n, CharT c);
+  constexpr BasicString();
+  constexpr explicit BasicString(const Allocator &alloc) noexcept;
+  constexpr BasicString(const BasicString &);
+  constexpr BasicString(const BasicString &other, const Allocator &alloc);
+  constexpr BasicString(BasicString &&) noexcept;
+  constexpr BasicString(BasicString &&other, const Allocator &alloc);
+  constexpr BasicString(const BasicString &other, size_type pos,
+                        size_type len = npos);
+  constexpr BasicString(const BasicString &other, size_type pos, size_type len,
+                        const Allocator &alloc);
+  constexpr BasicString(const CharT *, const Allocator &alloc = Allocator());
+  constexpr BasicString(const CharT *str, size_type count,
+                        const Allocator &alloc = Allocator());
+  constexpr explicit BasicString(std::basic_string_view<CharT, Traits> sv,
+                                 const Allocator &alloc = Allocator());
+  constexpr BasicString(size_t n, CharT c,
+                        const Allocator &alloc = Allocator());
+  template <size_t N>
+  constexpr BasicString(const StringConcat<CharT, Traits, N> &concat,
+                        const Allocator &alloc = Allocator());
+  template <std::input_iterator InputIt>
+  constexpr BasicString(InputIt first, InputIt last,
+                        const Allocator &alloc = Allocator());
   BasicString(std::nullptr_t) = delete;
 
   /* desturctor */
-  ~BasicString();
+  constexpr ~BasicString();
 
   /* operator= */
-  BasicString &operator=(BasicString);
+  constexpr BasicString &operator=(const BasicString &);
+  constexpr BasicString &operator=(BasicString &&) noexcept(
+      std::allocator_traits<Allocator>::propagate_on_container_move_assignment::
+          value ||
+      std::allocator_traits<Allocator>::is_always_equal::value);
+  constexpr BasicString &operator=(const CharT *);
 
-  Allocator get_allocator() const;
+  constexpr Allocator get_allocator() const;
 
   /* element access */
-  const_pointer c_str() const;
-  const_pointer data() const;
+  constexpr const_pointer c_str() const;
+  constexpr const_pointer data() const;
+  constexpr pointer data() noexcept;
   constexpr const_reference operator[](size_type index) const;
   constexpr reference operator[](size_type index);
   constexpr const_reference at(size_type index) const;
   constexpr reference at(size_type index);
-  operator std::basic_string_view<CharT, Traits>() const noexcept;
+  constexpr operator std::basic_string_view<CharT, Traits>() const noexcept;
+
+  /* iterators */
+  constexpr iterator begin() noexcept;
+  constexpr const_iterator begin() const noexcept;
+  constexpr const_iterator cbegin() const noexcept;
+  constexpr iterator end() noexcept;
+  constexpr const_iterator end() const noexcept;
+  constexpr const_iterator cend() const noexcept;
+  constexpr reverse_iterator rbegin() noexcept;
+  constexpr const_reverse_iterator rbegin() const noexcept;
+  constexpr const_reverse_iterator crbegin() const noexcept;
+  constexpr reverse_iterator rend() noexcept;
+  constexpr const_reverse_iterator rend() const noexcept;
+  constexpr const_reverse_iterator crend() const noexcept;
 
   /* capacity */
   constexpr size_type size() const;
   constexpr size_type length() const;
   constexpr size_type capacity() const;
   constexpr bool empty() const;
+  constexpr size_type max_size() const;
   constexpr void reserve(size_type new_cap);
+  constexpr void shrink_to_fit();
 
   /* modifiers */
   constexpr void pop_back();
   constexpr void push_back(CharT ch);
+  constexpr BasicString &append(const BasicString &str);
+  constexpr BasicString &append(const CharT *str);
+  constexpr BasicString &append(const CharT *str, size_type count);
+  constexpr BasicString &append(std::basic_string_view<CharT, Traits> sv);
+  constexpr BasicString &append(size_type count, CharT ch);
+  template <size_t N>
+  constexpr BasicString &append(const StringConcat<CharT, Traits, N> &concat);
+  constexpr BasicString &operator+=(const BasicString &str);
+  constexpr BasicString &operator+=(const CharT *str);
+  constexpr BasicString &operator+=(std::basic_string_view<CharT, Traits> sv);
+  constexpr BasicString &operator+=(CharT ch);
+  template <size_t N>
+  constexpr BasicString &
+  operator+=(const StringConcat<CharT, Traits, N> &concat);
   constexpr void replace(size_type pos, size_type len, const BasicString &str);
   constexpr void resize(size_type count, CharT ch);
+  // Grows the buffer to hold count characters without initializing the new
+  // ones, calls op(data, count) to fill them and keeps the first r
+  // characters, where r = op(...) <= count. As in C++23, op may write
+  // anywhere in [data, data + count] and must not throw.
+  template <typename Operation>
+  constexpr void resize_and_overwrite(size_type count, Operation op);
+  // Reserve-then-commit appending: reserve_append(count) returns room for
+  // count characters after the current end, left uninitialized, and
+  // commit_append(n) adds the first n <= count of them to the string.
+  constexpr pointer reserve_append(size_type count);
+  constexpr void commit_append(size_type count);
   constexpr void erase(size_type pos, size_type len);
+  constexpr iterator erase(const_iterator pos);
+  constexpr iterator erase(const_iterator first, const_iterator last);
   constexpr void clear();
 
   /* search */
-  size_type find(const BasicString &sub, size_type pos = 0) const;
+  constexpr size_type find(const BasicString &sub, size_type pos = 0) const;
+  constexpr size_type find(std::basic_string_view<CharT, Traits> sub,
+                           size_type pos = 0) const;
+  constexpr size_type find(const CharT *sub, size_type pos = 0) const;
+  constexpr size_type find(CharT ch, size_type pos = 0) const;
+  constexpr size_type rfind(const BasicString &str, size_type pos = npos) const;
+  constexpr size_type rfind(std::basic_string_view<CharT, Traits> str,
+                            size_type pos = npos) const;
+  constexpr size_type rfind(const CharT *str, size_type pos = npos) const;
+  constexpr size_type rfind(CharT ch, size_type pos = npos) const;
+  constexpr size_type find_first_of(const BasicString &str,
+                                    size_type pos = 0) const;
+  constexpr size_type find_first_of(std::basic_string_view<CharT, Traits> str,
+                                    size_type pos = 0) const;
+  constexpr size_type find_first_of(const CharT *str, size_type pos = 0) const;
+  constexpr size_type find_first_of(CharT ch, size_type pos = 0) const;
+  constexpr size_type find_first_not_of(const BasicString &str,
+                                        size_type pos = 0) const;
+  constexpr size_type
+  find_first_not_of(std::basic_string_view<CharT, Traits> str,
+                    size_type pos = 0) const;
+  constexpr size_type find_first_not_of(const CharT *str,
+                                        size_type pos = 0) const;
+  constexpr size_type find_first_not_of(CharT ch, size_type pos = 0) const;
+  constexpr size_type find_last_of(const BasicString &str,
+                                   size_type pos = npos) const;
+  constexpr size_type find_last_of(std::basic_string_view<CharT, Traits> str,
+                                   size_type pos = npos) const;
+  constexpr size_type find_last_of(const CharT *str,
+                                   size_type pos = npos) const;
+  constexpr size_type find_last_of(CharT ch, size_type pos = npos) const;
+  constexpr size_type find_last_not_of(const BasicString &str,
+                                       size_type pos = npos) const;
+  constexpr size_type
+  find_last_not_of(std::basic_string_view<CharT, Traits> str,
+                   size_type pos = npos) const;
+  constexpr size_type find_last_not_of(const CharT *str,
+                                       size_type pos = npos) const;
+  constexpr size_type find_last_not_of(CharT ch, size_type pos = npos) const;
 
   /* operations */
-  int compare(const BasicString &other) const;
-  bool starts_with(const BasicString &prefix) const;
-  bool ends_with(const BasicString &sub) const;
-
-  std::weak_ordering operator<=>(const BasicString &) const;
-  std::weak_ordering operator<=>(const char *) const;
-  bool operator==(const BasicString &) const;
-  bool operator!=(const BasicString &) const;
-  bool operator==(const char *) const;
-  bool operator!=(const char *) const;
+  constexpr int compare(const BasicString &other) const;
+  constexpr int compare(std::basic_string_view<CharT, Traits> other) const;
+  constexpr int compare(const CharT *other) const;
+  constexpr bool
+  starts_with(std::basic_string_view<CharT, Traits> prefix) const;
+  constexpr bool starts_with(CharT ch) const;
+  constexpr bool ends_with(std::basic_string_view<CharT, Traits> suffix) const;
+  constexpr bool ends_with(CharT ch) const;
+
+  using ordering = typename BasicStringOrdering<Traits>::type;
+
+  constexpr ordering operator<=>(const BasicString &) const;
+  constexpr ordering operator<=>(std::basic_string_view<CharT, Traits>) const;
+  constexpr ordering operator<=>(const CharT *) const;
+  constexpr bool operator==(const BasicString &) const;
+  constexpr bool operator!=(const BasicString &) const;
+  constexpr bool operator==(std::basic_string_view<CharT, Traits>) const;
+  constexpr bool operator!=(std::basic_string_view<CharT, Traits>) const;
+  constexpr bool operator==(const CharT *) const;
+  constexpr bool operator!=(const CharT *) const;
 
 private:
   using allocator_traits_type = std::allocator_traits<allocator_type>;
 
-  void allocate_and_copy(const CharT *str, size_t len);
-  void deallocate();
+  constexpr bool is_long() const noexcept;
+  constexpr pointer data_ptr() noexcept;
+  constexpr const_pointer data_ptr() const noexcept;
+  constexpr void set_size(size_type n) noexcept;
+  constexpr pointer init_storage(size_type len);
+  constexpr void init(const CharT *str, size_type len);
+  constexpr void reallocate(size_type new_cap);
+  constexpr void adopt(pointer new_data, size_type new_cap,
+                       size_type len) noexcept;
+  constexpr size_type grown_capacity(size_type required) const;
+  constexpr void assign_range(const CharT *str, size_type len);
+  constexpr void deallocate();
+  constexpr void steal(BasicString &other) noexcept;
+  constexpr pointer use_local() noexcept;
+  static constexpr bool equal_chars(const CharT *lhs, const CharT *rhs,
+                                    size_type n);
 
   template <typename T, typename Tr, typename Al>
   friend std::basic_ostream<T, Tr> &
   operator<<(std::basic_ostream<T, Tr> &os, const BasicString<T, Tr, Al> &str);
 
   template <typename T, typename Tr, typename Al>
-  friend std::basic_istream<T, Tr> &operator>>(std::basic_istream<T, Tr> &is,
-                                               BasicString<T, Tr, Al> &str);
+  friend std::basic_istream<T, Tr> &getline(std::basic_istream<T, Tr> &is,
+                                            BasicString<T, Tr, Al> &str,
+                                            T delim);
 
   template <typename T, typename Tr, typename Al>
   friend constexpr void swap(BasicString<T, Tr, Al> &lhs,
                              BasicString<T, Tr, Al> &rhs) noexcept;
 };
 
-#endif
+// Removes every character equal to value, or for which pred is true, in a
+// single compacting pass, and returns how many were removed. Found by
+// argument-dependent lookup, like std::erase for std::basic_string.
+template <typename CharT, typename Traits, typename Allocator, typename U>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+erase(BasicString<CharT, Traits, Allocator> &str, const U &value) {
+  using size_type = typename BasicString<CharT, Traits, Allocator>::size_type;
+  size_type old_size = str.size();
+  str.resize_and_overwrite(old_size, [&](CharT *data, size_type n) {
+    return static_cast<size_type>(std::remove(data, data + n, value) - data);
+  });
+  return old_size - str.size();
+}
+
+template <typename CharT, typename Traits, typename Allocator, typename Pred>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+erase_if(BasicString<CharT, Traits, Allocator> &str, Pred pred) {
+  using size_type = typename BasicString<CharT, Traits, Allocator>::size_type;
+  size_type old_size = str.size();
+  str.resize_and_overwrite(old_size, [&](CharT *data, size_type n) {
+    return static_cast<size_type>(std::remove_if(data, data + n, pred) -
+                                  data);
+  });
+  return old_size - str.size();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr bool
+BasicString<CharT, Traits, Allocator>::is_long() const noexcept {
+  return (size_ & long_flag) != 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::pointer
+BasicString<CharT, Traits, Allocator>::data_ptr() noexcept {
+  return is_long() ? rep_.heap.data : rep_.local;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::const_pointer
+BasicString<CharT, Traits, Allocator>::data_ptr() const noexcept {
+  return is_long() ? rep_.heap.data : rep_.local;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::set_size(size_type n) noexcept {
+  size_ = n | (size_ & long_flag);
+  traits_type::assign(data_ptr()[n], CharT());
+}
+
+// Sets up storage for len characters on a freshly constructed object and
+// records the size; the caller fills in the characters.
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::pointer
+BasicString<CharT, Traits, Allocator>::init_storage(size_type len) {
+  pointer p = rep_.local;
+  if (len > local_capacity) {
+    p = allocator_traits_type::allocate(allocator_, len + 1);
+    rep_.heap.data = p;
+    rep_.heap.capacity = len;
+    size_ = len | long_flag;
+  } else {
+    size_ = len;
+  }
+  traits_type::assign(p[len], CharT());
+  return p;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::init(const CharT *str, size_type len) {
+  traits_type::copy(init_storage(len), str, len);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::reallocate(size_type new_cap) {
+  size_type len = size();
+  pointer new_data = allocator_traits_type::allocate(allocator_, new_cap + 1);
+  traits_type::copy(new_data, data_ptr(), len + 1);
+  adopt(new_data, new_cap, len);
+}
+
+// Releases the current heap buffer, if any, and switches to new_data.
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void BasicString<CharT, Traits, Allocator>::adopt(
+    pointer new_data, size_type new_cap, size_type len) noexcept {
+  deallocate();
+
+  rep_.heap.data = new_data;
+  rep_.heap.capacity = new_cap;
+  size_ = len | long_flag;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::grown_capacity(
+    size_type required) const {
+  if (required > max_size()) {
+    throw std::length_error("BasicString: requested size exceeds max_size()");
+  }
+
+  return std::min(growth_policy::next_capacity(capacity(), required),
+                  max_size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::assign_range(const CharT *str,
+                                                    size_type len) {
+  if (len > capacity()) {
+    set_size(0);
+    reallocate(len);
+  }
+  traits_type::move(data_ptr(), str, len);
+  set_size(len);
+}
 
-// template <typename CharT, typename Traits, typename Allocator, typename U>
-// inline BasicString<CharT, Traits, Allocator>::size_type
-// erase(BasicString<CharT, Traits, Allocator>& str, const U& value)
-// {
-//   auto it = std::remove(c.begin(), c.end(), value);
-//   auto r = c.end() - it;
-//   c.erase(it, c.end());
-//   return r;
-// }
-
-// template <typename CharT, typename Traits, typename Allocator, typename Pred>
-// inline BasicString<CharT, Traits, Allocator>::size_type
-// erase_if(BasicString<CharT, Traits, Allocator>& str, Pred pred)
-// {
-//   auto it = std::remove_if(c.begin(), c.end(), pred);
-//   auto r = c.end() - it;
-//   c.erase(it, c.end());
-//   return r;
-// }
-
-template <typename CharT, typename Traits, typename Allocator>
-inline void
-BasicString<CharT, Traits, Allocator>::allocate_and_copy(const CharT *str,
-                                                         size_t len) {
-  data_ = allocator_traits_type::allocate(allocator_, len + 1);
-  std::memcpy(data_, str, len * sizeof(CharT));
-  data_[len] = '\0';
-  size_ = len;
-  capacity_ = len + 1;
-}
-
-template <typename CharT, typename Traits, typename Allocator>
-inline void BasicString<CharT, Traits, Allocator>::deallocate() {
-  if (data_) {
-    allocator_traits_type::deallocate(allocator_, data_, capacity_);
-    data_ = nullptr;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void BasicString<CharT, Traits, Allocator>::deallocate() {
+  if (is_long()) {
+    allocator_traits_type::deallocate(allocator_, rep_.heap.data,
+                                      rep_.heap.capacity + 1);
     size_ = 0;
-    capacity_ = 0;
+    traits_type::assign(use_local()[0], CharT());
   }
 }
 
+// Takes over other's buffer; the allocator is left to the caller.
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::BasicString()
-    : data_(nullptr), size_(0), capacity_(0) {}
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::steal(BasicString &other) noexcept {
+  rep_ = other.rep_;
+  size_ = other.size_;
+  other.size_ = 0;
+  traits_type::assign(other.use_local()[0], CharT());
+}
 
+// Makes the inline buffer the active member of rep_ again after the heap
+// representation was in use. Constant evaluation tracks the active union
+// member and only lets a direct assignment to the array switch it; at run
+// time the buffer is just reused.
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::BasicString(
+inline constexpr typename BasicString<CharT, Traits, Allocator>::pointer
+BasicString<CharT, Traits, Allocator>::use_local() noexcept {
+  if (std::is_constant_evaluated()) {
+    for (size_type i = 0; i <= local_capacity; ++i)
+      rep_.local[i] = CharT();
+  }
+  return rep_.local;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString()
+    : rep_(), size_(0) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    const Allocator &alloc) noexcept
+    : rep_(), size_(0), allocator_(alloc) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
     const BasicString &other)
-    : data_(nullptr), size_(other.size_), capacity_(other.capacity_),
-      allocator_(other.allocator_) {
-  if (size_ > 0) {
-    data_ = allocator_traits_type::allocate(allocator_, size_ + 1);
-    std::memcpy(data_, other.data_, size_ * sizeof(CharT));
-    data_[size_] = '\0';
+    : rep_(), size_(0),
+      allocator_(allocator_traits_type::select_on_container_copy_construction(
+          other.allocator_)) {
+  init(other.data(), other.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    const BasicString &other, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  init(other.data(), other.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    BasicString &&other) noexcept
+    : rep_(), size_(0), allocator_(std::move(other.allocator_)) {
+  steal(other);
+}
+
+// A buffer can only change hands between equal allocators; otherwise the
+// characters are copied into memory from alloc.
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    BasicString &&other, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  if constexpr (allocator_traits_type::is_always_equal::value) {
+    steal(other);
+  } else if (allocator_ == other.allocator_) {
+    steal(other);
   } else {
-    data_ = nullptr;
+    init(other.data(), other.size());
   }
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::BasicString(
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
     const BasicString &other, size_type pos, size_type len)
-    : allocator_(other.allocator_) {
-  if (pos > other.size_) {
+    : BasicString(other, pos, len, other.allocator_) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    const BasicString &other, size_type pos, size_type len,
+    const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  if (pos > other.size()) {
     throw std::out_of_range("Position is out of range.");
   }
 
-  size_ = (len == npos) ? other.size_ - pos : std::min(len, other.size_ - pos);
-  capacity_ = size_ + 1;
-  data_ = allocator_traits_type::allocate(allocator_, capacity_);
+  init(other.data() + pos, std::min(len, other.size() - pos));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    const CharT *copy, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  init(copy, traits_type::length(copy));
+}
 
-  std::memcpy(data_, other.data_ + pos, size_ * sizeof(CharT));
-  data_[size_] = '\0';
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    const CharT *str, size_type count, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  init(str, count);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::BasicString(const CharT *copy) {
-  size_type len = traits_type::length(copy);
-  allocate_and_copy(copy, len);
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    std::basic_string_view<CharT, Traits> sv, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  init(sv.data(), sv.size());
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::BasicString(size_t n, CharT c) {
-  data_ = allocator_traits_type::allocate(allocator_, n + 1);
-  std::memset(data_, c, n);
-  size_ = n;
-  capacity_ = n + 1;
-  data_[size_] = '\0';
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    size_t n, CharT c, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  traits_type::assign(init_storage(n), n, c);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::~BasicString() {
+template <size_t N>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    const StringConcat<CharT, Traits, N> &concat, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  concat.copy_to(init_storage(concat.size()));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <std::input_iterator InputIt>
+inline constexpr BasicString<CharT, Traits, Allocator>::BasicString(
+    InputIt first, InputIt last, const Allocator &alloc)
+    : rep_(), size_(0), allocator_(alloc) {
+  if constexpr (std::forward_iterator<InputIt>) {
+    auto len = static_cast<size_type>(std::distance(first, last));
+    std::copy(first, last, init_storage(len));
+  } else {
+    init_storage(0);
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::~BasicString() {
   deallocate();
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline typename BasicString<CharT, Traits, Allocator>::size_type
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
 BasicString<CharT, Traits, Allocator>::find(const BasicString &sub,
                                             size_type pos) const {
-  if (pos > size_)
+  return find(std::basic_string_view<CharT, Traits>(sub), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find(
+    std::basic_string_view<CharT, Traits> sub, size_type pos) const {
+  if (pos > size())
+    return npos;
+
+  size_type found = string_search::find<CharT, Traits>(
+      data() + pos, size() - pos, sub.data(), sub.size());
+  return found == string_search::npos ? npos : found + pos;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find(const CharT *sub,
+                                            size_type pos) const {
+  return find(std::basic_string_view<CharT, Traits>(sub), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find(CharT ch, size_type pos) const {
+  if (pos >= size())
+    return npos;
+
+  const CharT *p = traits_type::find(data() + pos, size() - pos, ch);
+  return p ? static_cast<size_type>(p - data()) : npos;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::rfind(const BasicString &str,
+                                             size_type pos) const {
+  return rfind(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::rfind(
+    std::basic_string_view<CharT, Traits> str, size_type pos) const {
+  if (str.size() > size())
+    return npos;
+
+  size_type end = std::min(pos, size() - str.size()) + str.size();
+  size_type found = string_search::rfind<CharT, Traits>(data(), end, str.data(),
+                                                        str.size());
+  return found == string_search::npos ? npos : found;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::rfind(const CharT *str,
+                                             size_type pos) const {
+  return rfind(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::rfind(CharT ch, size_type pos) const {
+  return find_last_of(std::basic_string_view<CharT, Traits>(&ch, 1), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_of(const BasicString &str,
+                                                     size_type pos) const {
+  return find_first_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_of(
+    std::basic_string_view<CharT, Traits> str, size_type pos) const {
+  if (pos >= size())
+    return npos;
+
+  size_type found = string_search::find_of<CharT, Traits, true>(
+      data() + pos, size() - pos, str.data(), str.size());
+  return found == string_search::npos ? npos : found + pos;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_of(const CharT *str,
+                                                     size_type pos) const {
+  return find_first_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_of(CharT ch,
+                                                     size_type pos) const {
+  return find(ch, pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_not_of(const BasicString &str,
+                                                         size_type pos) const {
+  return find_first_not_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_not_of(
+    std::basic_string_view<CharT, Traits> str, size_type pos) const {
+  if (pos >= size())
+    return npos;
+
+  size_type found = string_search::find_of<CharT, Traits, false>(
+      data() + pos, size() - pos, str.data(), str.size());
+  return found == string_search::npos ? npos : found + pos;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_not_of(const CharT *str,
+                                                         size_type pos) const {
+  return find_first_not_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_first_not_of(CharT ch,
+                                                         size_type pos) const {
+  return find_first_not_of(std::basic_string_view<CharT, Traits>(&ch, 1), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_of(const BasicString &str,
+                                                    size_type pos) const {
+  return find_last_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_of(
+    std::basic_string_view<CharT, Traits> str, size_type pos) const {
+  if (empty())
     return npos;
 
-  // for (size_type i = pos; i <= size_ - sub.size_; ++i)
-  // {
-  //   bool match = true;
-  //   for (size_type j = 0; j < sub.size_; ++j)
-  //   {
-  //     if (Traits::eq(data_[i + j], sub.data_[j]))
-  //     {
-  //       continue;
-  //     } else {
-  //       match = false;
-  //       break;
-  //     }
-  //   }
+  size_type found = string_search::rfind_of<CharT, Traits, true>(
+      data(), std::min(pos, size() - 1) + 1, str.data(), str.size());
+  return found == string_search::npos ? npos : found;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_of(const CharT *str,
+                                                    size_type pos) const {
+  return find_last_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_of(CharT ch,
+                                                    size_type pos) const {
+  return find_last_of(std::basic_string_view<CharT, Traits>(&ch, 1), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_not_of(const BasicString &str,
+                                                        size_type pos) const {
+  return find_last_not_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_not_of(
+    std::basic_string_view<CharT, Traits> str, size_type pos) const {
+  if (empty())
+    return npos;
 
-  //   if (match) return i;
-  // }
+  size_type found = string_search::rfind_of<CharT, Traits, false>(
+      data(), std::min(pos, size() - 1) + 1, str.data(), str.size());
+  return found == string_search::npos ? npos : found;
+}
 
-  // return npos;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_not_of(const CharT *str,
+                                                        size_type pos) const {
+  return find_last_not_of(std::basic_string_view<CharT, Traits>(str), pos);
+}
 
-  const_pointer start = c_str() + pos;
-  const_pointer result = std::search(start, c_str() + size_, sub.c_str(),
-                                     sub.c_str() + sub.size());
-  return result != c_str() + size_ ? result - c_str() : npos;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::find_last_not_of(CharT ch,
+                                                        size_type pos) const {
+  return find_last_not_of(std::basic_string_view<CharT, Traits>(&ch, 1), pos);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline int
+inline constexpr int
 BasicString<CharT, Traits, Allocator>::compare(const BasicString &other) const {
-  return Traits::compare(c_str(), other.c_str(), std::min(size_, other.size_));
+  return compare(std::basic_string_view<CharT, Traits>(other));
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline bool BasicString<CharT, Traits, Allocator>::starts_with(
-    const BasicString &prefix) const {
-  if (prefix.size_ > size_)
-    return false;
+inline constexpr int BasicString<CharT, Traits, Allocator>::compare(
+    std::basic_string_view<CharT, Traits> other) const {
+  size_type len = size();
+  int result =
+      traits_type::compare(data(), other.data(), std::min(len, other.size()));
+  if (result != 0)
+    return result;
+  return len < other.size() ? -1 : (len > other.size() ? 1 : 0);
+}
 
-  return find(prefix, 0) == 0;
+// Walks the C string once, stopping at the first difference or at its
+// terminator, so it is never measured separately.
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr int
+BasicString<CharT, Traits, Allocator>::compare(const CharT *other) const {
+  const_pointer p = data();
+  size_type len = size();
+  for (size_type i = 0; i < len; ++i) {
+    if (!traits_type::eq(p[i], other[i]))
+      return traits_type::lt(p[i], other[i]) ? -1 : 1;
+    if (traits_type::eq(other[i], CharT()))
+      return 1;
+  }
+  return traits_type::eq(other[len], CharT()) ? 0 : -1;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline bool
-BasicString<CharT, Traits, Allocator>::ends_with(const BasicString &sub) const {
-  if (sub.size_ > size_)
-    return false;
+inline constexpr bool BasicString<CharT, Traits, Allocator>::starts_with(
+    std::basic_string_view<CharT, Traits> prefix) const {
+  return prefix.size() <= size() &&
+         traits_type::compare(data(), prefix.data(), prefix.size()) == 0;
+}
 
-  size_type pos = size_ - sub.size_;
-  return find(sub, pos) == pos;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr bool
+BasicString<CharT, Traits, Allocator>::starts_with(CharT ch) const {
+  return !empty() && traits_type::eq(data()[0], ch);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline std::weak_ordering
-BasicString<CharT, Traits, Allocator>::operator<=>(const char *other) const {
-  return std::lexicographical_compare_three_way(data_, data_ + size_, other,
-                                                other + std::strlen(other));
+inline constexpr bool BasicString<CharT, Traits, Allocator>::ends_with(
+    std::basic_string_view<CharT, Traits> suffix) const {
+  return suffix.size() <= size() &&
+         traits_type::compare(data() + size() - suffix.size(), suffix.data(),
+                              suffix.size()) == 0;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline bool
-BasicString<CharT, Traits, Allocator>::operator==(const char *other) const {
-  return (this->operator<=>(other)) == std::weak_ordering::equivalent;
+inline constexpr bool
+BasicString<CharT, Traits, Allocator>::ends_with(CharT ch) const {
+  return !empty() && traits_type::eq(data()[size() - 1], ch);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline bool
-BasicString<CharT, Traits, Allocator>::operator!=(const char *other) const {
-  return (this->operator<=>(other)) != std::weak_ordering::equivalent;
+inline constexpr bool BasicString<CharT, Traits, Allocator>::equal_chars(
+    const CharT *lhs, const CharT *rhs, size_type n) {
+  if constexpr (std::is_same_v<Traits, std::char_traits<CharT>>) {
+    // Plain character equality is byte equality, so skip the ordered
+    // per-element comparison.
+    if (!std::is_constant_evaluated())
+      return std::memcmp(lhs, rhs, n * sizeof(CharT)) == 0;
+  }
+  return traits_type::compare(lhs, rhs, n) == 0;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline bool BasicString<CharT, Traits, Allocator>::operator==(
+inline constexpr bool BasicString<CharT, Traits, Allocator>::operator==(
     const BasicString &other) const {
-  return (this->operator<=>(other)) == std::weak_ordering::equivalent;
+  return size() == other.size() && equal_chars(data(), other.data(), size());
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline bool BasicString<CharT, Traits, Allocator>::operator!=(
+inline constexpr bool BasicString<CharT, Traits, Allocator>::operator!=(
     const BasicString &other) const {
-  return (this->operator<=>(other)) != std::weak_ordering::equivalent;
+  return !(*this == other);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline std::weak_ordering BasicString<CharT, Traits, Allocator>::operator<=>(
+inline constexpr bool BasicString<CharT, Traits, Allocator>::operator==(
+    std::basic_string_view<CharT, Traits> other) const {
+  return size() == other.size() && equal_chars(data(), other.data(), size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr bool BasicString<CharT, Traits, Allocator>::operator!=(
+    std::basic_string_view<CharT, Traits> other) const {
+  return !(*this == other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr bool
+BasicString<CharT, Traits, Allocator>::operator==(const CharT *other) const {
+  return compare(other) == 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr bool
+BasicString<CharT, Traits, Allocator>::operator!=(const CharT *other) const {
+  return compare(other) != 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::ordering
+BasicString<CharT, Traits, Allocator>::operator<=>(
     const BasicString &other) const {
-  // if (size_ < other.size_) {
-  //   return std::weak_ordering::less;
-  // } else if (size_ > other.size_) {
-  //   return std::weak_ordering::greater;
-  // }
+  return static_cast<ordering>(compare(other) <=> 0);
+}
 
-  // for (typename BasicString<CharT, Traits, Allocator>::size_type i = 0;
-  //      i < size_; ++i) {
-  //   if (Traits::lt(data_[i], other.data_[i])) {
-  //     return std::weak_ordering::less;
-  //   } else if (Traits::eq(data_[i], other.data_[i])) {
-  //     continue;
-  //   } else {
-  //     return std::weak_ordering::greater;
-  //   }
-  // }
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::ordering
+BasicString<CharT, Traits, Allocator>::operator<=>(
+    std::basic_string_view<CharT, Traits> other) const {
+  return static_cast<ordering>(compare(other) <=> 0);
+}
 
-  // return std::weak_ordering::equivalent;
-  return std::lexicographical_compare_three_way(
-      data_, data_ + size_, other.data_, other.data_ + other.size_);
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::ordering
+BasicString<CharT, Traits, Allocator>::operator<=>(const CharT *other) const {
+  return static_cast<ordering>(compare(other) <=> 0);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void BasicString<CharT, Traits, Allocator>::pop_back() {
-  if (size_ > 0) {
-    size_ -= 1;
-    data_[size_] = '\0';
+  if (size() > 0) {
+    set_size(size() - 1);
   }
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void
 BasicString<CharT, Traits, Allocator>::push_back(CharT ch) {
-  if (size_ + 1 >= capacity_) {
-    size_type new_cap = capacity_ == 0 ? 1 : capacity_ * 2;
+  size_type len = size();
+  if (len == capacity()) {
+    reallocate(grown_capacity(len + 1));
+  }
+
+  traits_type::assign(data_ptr()[len], ch);
+  set_size(len + 1);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::append(const BasicString &str) {
+  return append(str.data(), str.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::append(const CharT *str) {
+  return append(str, traits_type::length(str));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::append(const CharT *str,
+                                              size_type count) {
+  size_type len = size();
+  if (count > capacity() - len) {
+    // str may point into our own buffer, so the old one is released only
+    // after the copy.
+    size_type new_cap = grown_capacity(len + count);
     pointer new_data = allocator_traits_type::allocate(allocator_, new_cap + 1);
+    traits_type::copy(new_data, data_ptr(), len);
+    traits_type::copy(new_data + len, str, count);
+    adopt(new_data, new_cap, len);
+  } else {
+    traits_type::copy(data_ptr() + len, str, count);
+  }
 
-    if (data_) {
-      std::memcpy(new_data, data_, size_ * sizeof(CharT));
-      allocator_traits_type::deallocate(allocator_, data_, capacity_);
-    }
+  set_size(len + count);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::append(
+    std::basic_string_view<CharT, Traits> sv) {
+  return append(sv.data(), sv.size());
+}
 
-    new_data[size_] = ch;
-    new_data[size_ + 1] = '\0';
-    data_ = new_data;
-    size_ += 1;
-    capacity_ = new_cap;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::append(size_type count, CharT ch) {
+  size_type len = size();
+  if (count > capacity() - len) {
+    reallocate(grown_capacity(len + count));
+  }
+
+  traits_type::assign(data_ptr() + len, count, ch);
+  set_size(len + count);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <size_t N>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::append(
+    const StringConcat<CharT, Traits, N> &concat) {
+  size_type len = size();
+  size_type count = concat.size();
+  if (count > capacity() - len) {
+    size_type new_cap = grown_capacity(len + count);
+    pointer new_data = allocator_traits_type::allocate(allocator_, new_cap + 1);
+    traits_type::copy(new_data, data_ptr(), len);
+    concat.copy_to(new_data + len);
+    adopt(new_data, new_cap, len);
   } else {
-    data_[size_] = ch;
-    size_ += 1;
+    concat.copy_to(data_ptr() + len);
   }
+
+  set_size(len + count);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator+=(const BasicString &str) {
+  return append(str.data(), str.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator+=(const CharT *str) {
+  return append(str);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator+=(
+    std::basic_string_view<CharT, Traits> sv) {
+  return append(sv.data(), sv.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator+=(CharT ch) {
+  push_back(ch);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <size_t N>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator+=(
+    const StringConcat<CharT, Traits, N> &concat) {
+  return append(concat);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void
 BasicString<CharT, Traits, Allocator>::replace(size_type pos, size_type len,
                                                const BasicString &str) {
-  if (pos > size_) {
+  size_type old_size = size();
+  if (pos > old_size) {
     throw std::out_of_range("Position is out of range.");
   }
 
-  if (len > size_) {
-    len = size_;
+  if (this == &str) {
+    BasicString copy(str);
+    replace(pos, len, copy);
+    return;
   }
 
-  size_type new_size = size_ - len + str.size_;
+  len = std::min(len, old_size - pos);
+  size_type tail = old_size - pos - len;
+  size_type new_size = old_size - len + str.size();
 
-  if (new_size > capacity_) {
-    size_type new_cap = new_size + 1;
-    pointer new_data = allocator_traits_type::allocate(allocator_, new_cap);
-
-    std::memcpy(new_data, data_, pos * sizeof(CharT));
-    std::memcpy(new_data + pos, str.data_, str.size_ * sizeof(CharT));
-    std::memcpy(new_data + pos + str.size_, data_ + pos + len,
-                (size_ - len - pos) * sizeof(CharT));
+  if (new_size > capacity()) {
+    size_type new_cap = grown_capacity(new_size);
+    pointer new_data = allocator_traits_type::allocate(allocator_, new_cap + 1);
 
-    allocator_traits_type::deallocate(allocator_, data_, capacity_);
+    const_pointer old_data = data_ptr();
+    traits_type::copy(new_data, old_data, pos);
+    traits_type::copy(new_data + pos, str.data(), str.size());
+    traits_type::copy(new_data + pos + str.size(), old_data + pos + len, tail);
 
-    data_ = new_data;
-    size_ = new_size;
-    capacity_ = new_cap;
+    adopt(new_data, new_cap, 0);
   } else {
-    std::memcpy(data_ + pos, str.data_, str.size_ * sizeof(CharT));
-    std::memcpy(data_ + pos + str.size_, data_ + pos + len,
-                (size_ - len - pos) * sizeof(CharT));
-    size_ = new_size;
+    pointer p = data_ptr();
+    traits_type::move(p + pos + str.size(), p + pos + len, tail);
+    traits_type::copy(p + pos, str.data(), str.size());
   }
 
-  data_[size_] = '\0';
+  set_size(new_size);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void
 BasicString<CharT, Traits, Allocator>::resize(size_type count, CharT ch) {
-  if (count > size_) {
-    if (count > capacity_) {
-      pointer new_data = allocator_traits_type::allocate(allocator_, count + 1);
+  size_type len = size();
+  if (count > len) {
+    if (count > capacity()) {
+      reallocate(grown_capacity(count));
+    }
+    traits_type::assign(data_ptr() + len, count - len, ch);
+  }
 
-      std::memcpy(new_data, data_, size_ * sizeof(CharT));
+  set_size(count);
+}
 
-      std::memset(new_data + size_, ch, (count - size_) * sizeof(CharT));
+template <typename CharT, typename Traits, typename Allocator>
+template <typename Operation>
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::resize_and_overwrite(size_type count,
+                                                            Operation op) {
+  if (count > capacity()) {
+    reallocate(grown_capacity(count));
+  }
 
-      allocator_traits_type::deallocate(allocator_, data_, capacity_);
+  size_type result = static_cast<size_type>(std::move(op)(data_ptr(), count));
+  set_size(result);
+}
 
-      data_ = new_data;
-      capacity_ = count + 1;
-    } else {
-      std::memset(data_ + size_, ch, (count - size_) * sizeof(CharT));
-    }
-  } else if (count < size_) {
-    size_ = count;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::pointer
+BasicString<CharT, Traits, Allocator>::reserve_append(size_type count) {
+  size_type len = size();
+  if (count > capacity() - len) {
+    reallocate(grown_capacity(len + count));
   }
+  return data_ptr() + len;
+}
 
-  data_[count] = '\0';
-  size_ = count;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void
+BasicString<CharT, Traits, Allocator>::commit_append(size_type count) {
+  set_size(size() + count);
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void
 BasicString<CharT, Traits, Allocator>::erase(size_type pos, size_type len) {
-  if (pos > size_) {
+  size_type old_size = size();
+  if (pos > old_size) {
     throw std::out_of_range("Position is out of range.");
   }
 
-  len = std::min(len, size_ - pos);
+  len = std::min(len, old_size - pos);
 
-  std::memmove(data_ + pos, data_ + pos + len,
-               (size_ - len - pos) * sizeof(CharT));
-  size_ -= len;
-  data_[size_] = '\0';
+  pointer p = data_ptr();
+  traits_type::move(p + pos, p + pos + len, old_size - pos - len);
+  set_size(old_size - len);
 }
 
+// Writes the characters in one call, embedded NULs included. A field width
+// still pads the output the same way it does for std::string.
 template <typename CharT, typename Traits, typename Allocator>
 inline std::basic_ostream<CharT, Traits> &
 operator<<(std::basic_ostream<CharT, Traits> &os,
            const BasicString<CharT, Traits, Allocator> &str) {
-  os << str.c_str();
-  return os;
+  if (os.width() > 0)
+    return os << std::basic_string_view<CharT, Traits>(str);
+  return os.write(str.data(), static_cast<std::streamsize>(str.size()));
 }
 
+// Replaces str with the rest of the input, whitespace included. The
+// characters are pulled from the stream buffer with sgetn straight into the
+// string's spare capacity (see reserve_append), which grows geometrically.
+// Sets eofbit at the end of input and failbit if nothing was read.
 template <typename CharT, typename Traits, typename Allocator>
 inline std::basic_istream<CharT, Traits> &
 operator>>(std::basic_istream<CharT, Traits> &is,
            BasicString<CharT, Traits, Allocator> &str) {
+  using size_type = typename BasicString<CharT, Traits, Allocator>::size_type;
+
+  typename std::basic_istream<CharT, Traits>::sentry guard(is, true);
+  if (!guard)
+    return is;
+
+  str.clear();
+  std::basic_streambuf<CharT, Traits> *buf = is.rdbuf();
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  for (;;) {
+    size_type len = str.size();
+    CharT *out = str.reserve_append(len == str.capacity() ? 1 : 0);
+    size_type spare = std::min<size_type>(
+        str.capacity() - len, std::numeric_limits<std::streamsize>::max());
+    std::streamsize got =
+        buf->sgetn(out, static_cast<std::streamsize>(spare));
+    if (got <= 0) {
+      state |= std::ios_base::eofbit;
+      break;
+    }
+    str.commit_append(static_cast<size_type>(got));
+  }
+
+  if (str.empty())
+    state |= std::ios_base::failbit;
+  is.setstate(state);
+  return is;
+}
+
+// Reads up to the next delim, which is extracted but not stored. str keeps
+// its capacity, so reading line after line into the same string only
+// allocates when a line is longer than every line before it. The scan runs
+// through istream::getline, which searches the buffered input in bulk.
+template <typename CharT, typename Traits, typename Allocator>
+inline std::basic_istream<CharT, Traits> &
+getline(std::basic_istream<CharT, Traits> &is,
+        BasicString<CharT, Traits, Allocator> &str, CharT delim) {
+  using size_type = typename BasicString<CharT, Traits, Allocator>::size_type;
+
   str.clear();
+  size_type len = 0;
+  for (;;) {
+    if (len == str.capacity())
+      str.reallocate(str.grown_capacity(len + 1));
+
+    // The buffer holds capacity() + 1 characters, so getline's terminating
+    // NUL always fits.
+    size_type spare = std::min<size_type>(
+        str.capacity() - len, std::numeric_limits<std::streamsize>::max() - 1);
+    is.getline(str.data_ptr() + len, static_cast<std::streamsize>(spare + 1),
+               delim);
+    size_type got = static_cast<size_type>(is.gcount());
+
+    if (is.fail() && !is.eof() && !is.bad() && got == spare) {
+      // Filled the spare capacity without reaching delim: grow and go on.
+      is.clear(is.rdstate() & ~std::ios_base::failbit);
+      len += got;
+      str.set_size(len);
+      continue;
+    }
 
-  typename BasicString<CharT, Traits, Allocator>::size_type n = 0;
-  constexpr size_t buffer_size = 128;
+    if (is.eof() || is.fail()) {
+      len += got;
+      // Characters read by an earlier round still count as a line.
+      if (len > 0 && is.fail() && !is.bad())
+        is.clear(is.rdstate() & ~std::ios_base::failbit);
+    } else {
+      len += got - 1;
+    }
+    str.set_size(len);
+    return is;
+  }
+}
 
-  CharT buffer[buffer_size];
+template <typename CharT, typename Traits, typename Allocator>
+inline std::basic_istream<CharT, Traits> &
+getline(std::basic_istream<CharT, Traits> &is,
+        BasicString<CharT, Traits, Allocator> &str) {
+  return getline(is, str, is.widen('\n'));
+}
 
-  while (is.read(buffer, buffer_size)) {
-    size_t num_read = is.gcount();
-    if (num_read > 0) {
-      str.allocate_and_copy(buffer, num_read);
-      n += num_read;
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator=(const BasicString &other) {
+  if (this == &other)
+    return *this;
+
+  if constexpr (allocator_traits_type::propagate_on_container_copy_assignment::
+                    value) {
+    if (allocator_ != other.allocator_) {
+      deallocate();
     }
+    allocator_ = other.allocator_;
   }
 
-  if (is.gcount() > 0) {
-    str.allocate_and_copy(buffer, is.gcount());
+  assign_range(other.data(), other.size());
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator=(BasicString &&other) noexcept(
+    std::allocator_traits<Allocator>::propagate_on_container_move_assignment::
+        value ||
+    std::allocator_traits<Allocator>::is_always_equal::value) {
+  if (this == &other)
+    return *this;
+
+  if constexpr (!allocator_traits_type::propagate_on_container_move_assignment::
+                    value &&
+                !allocator_traits_type::is_always_equal::value) {
+    // The buffer belongs to an allocator we cannot take over, so copy.
+    if (allocator_ != other.allocator_) {
+      assign_range(other.data(), other.size());
+      return *this;
+    }
   }
 
-  return is;
+  deallocate();
+  if constexpr (allocator_traits_type::propagate_on_container_move_assignment::
+                    value) {
+    allocator_ = std::move(other.allocator_);
+  }
+  steal(other);
+  return *this;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator> &
-BasicString<CharT, Traits, Allocator>::operator=(BasicString other) {
-  swap(*this, other);
+inline constexpr BasicString<CharT, Traits, Allocator> &
+BasicString<CharT, Traits, Allocator>::operator=(const CharT *str) {
+  assign_range(str, traits_type::length(str));
   return *this;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline Allocator BasicString<CharT, Traits, Allocator>::get_allocator() const {
+inline constexpr Allocator
+BasicString<CharT, Traits, Allocator>::get_allocator() const {
   return allocator_;
-  ;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline typename BasicString<CharT, Traits, Allocator>::const_pointer
+inline constexpr typename BasicString<CharT, Traits, Allocator>::const_pointer
 BasicString<CharT, Traits, Allocator>::c_str() const {
-  return data_;
+  return data_ptr();
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::const_pointer
+inline constexpr BasicString<CharT, Traits, Allocator>::const_pointer
 BasicString<CharT, Traits, Allocator>::data() const {
-  return data_;
+  return data_ptr();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::pointer
+BasicString<CharT, Traits, Allocator>::data() noexcept {
+  return data_ptr();
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr BasicString<CharT, Traits, Allocator>::const_reference
 BasicString<CharT, Traits, Allocator>::operator[](size_type index) const {
-  return data_[index];
+  return data_ptr()[index];
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr BasicString<CharT, Traits, Allocator>::reference
 BasicString<CharT, Traits, Allocator>::operator[](size_type index) {
-  return data_[index];
+  return data_ptr()[index];
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr BasicString<CharT, Traits, Allocator>::const_reference
 BasicString<CharT, Traits, Allocator>::at(size_type index) const {
-  if (index >= size_) {
+  if (index >= size()) {
     throw std::out_of_range("BasicString::at: position out of range");
   }
-  return data_[index];
+  return data_ptr()[index];
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr BasicString<CharT, Traits, Allocator>::reference
 BasicString<CharT, Traits, Allocator>::at(size_type index) {
-  if (index >= size_) {
+  if (index >= size()) {
     throw std::out_of_range("BasicString::at: position out of range");
   }
-  return data_[index];
+  return data_ptr()[index];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>::
+operator std::basic_string_view<CharT, Traits>() const noexcept {
+  return std::basic_string_view<CharT, Traits>(data(), size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::iterator
+BasicString<CharT, Traits, Allocator>::begin() noexcept {
+  return data_ptr();
 }
 
 template <typename CharT, typename Traits, typename Allocator>
-inline BasicString<CharT, Traits, Allocator>::operator std::basic_string_view<
-    CharT, Traits>() const noexcept {
-  return std::basic_string_view<CharT, Traits>(data_, size_);
+inline constexpr typename BasicString<CharT, Traits, Allocator>::const_iterator
+BasicString<CharT, Traits, Allocator>::begin() const noexcept {
+  return data_ptr();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::const_iterator
+BasicString<CharT, Traits, Allocator>::cbegin() const noexcept {
+  return data_ptr();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::iterator
+BasicString<CharT, Traits, Allocator>::end() noexcept {
+  return data_ptr() + size();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::const_iterator
+BasicString<CharT, Traits, Allocator>::end() const noexcept {
+  return data_ptr() + size();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::const_iterator
+BasicString<CharT, Traits, Allocator>::cend() const noexcept {
+  return data_ptr() + size();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr
+    typename BasicString<CharT, Traits, Allocator>::reverse_iterator
+    BasicString<CharT, Traits, Allocator>::rbegin() noexcept {
+  return reverse_iterator(end());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr
+    typename BasicString<CharT, Traits, Allocator>::const_reverse_iterator
+    BasicString<CharT, Traits, Allocator>::rbegin() const noexcept {
+  return const_reverse_iterator(end());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr
+    typename BasicString<CharT, Traits, Allocator>::const_reverse_iterator
+    BasicString<CharT, Traits, Allocator>::crbegin() const noexcept {
+  return const_reverse_iterator(end());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr
+    typename BasicString<CharT, Traits, Allocator>::reverse_iterator
+    BasicString<CharT, Traits, Allocator>::rend() noexcept {
+  return reverse_iterator(begin());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr
+    typename BasicString<CharT, Traits, Allocator>::const_reverse_iterator
+    BasicString<CharT, Traits, Allocator>::rend() const noexcept {
+  return const_reverse_iterator(begin());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr
+    typename BasicString<CharT, Traits, Allocator>::const_reverse_iterator
+    BasicString<CharT, Traits, Allocator>::crend() const noexcept {
+  return const_reverse_iterator(begin());
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
 BasicString<CharT, Traits, Allocator>::size() const {
-  return size_;
+  return size_ & ~long_flag;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
 BasicString<CharT, Traits, Allocator>::length() const {
-  return size_;
+  return size();
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
 BasicString<CharT, Traits, Allocator>::capacity() const {
-  return capacity_;
+  return is_long() ? rep_.heap.capacity : local_capacity;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr bool BasicString<CharT, Traits, Allocator>::empty() const {
-  return size_ == 0;
+  return size() == 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::size_type
+BasicString<CharT, Traits, Allocator>::max_size() const {
+  return std::min<size_type>(allocator_traits_type::max_size(allocator_),
+                             ~long_flag) -
+         1;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void
 BasicString<CharT, Traits, Allocator>::reserve(size_type new_cap) {
-  if (new_cap <= capacity_)
+  if (new_cap <= capacity())
     return;
 
-  pointer new_data = allocator_traits_type::allocate(allocator_, new_cap);
+  reallocate(grown_capacity(new_cap));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void BasicString<CharT, Traits, Allocator>::shrink_to_fit() {
+  if (!is_long())
+    return;
 
-  if (data_ != nullptr) {
-    std::memcpy(new_data, data_, size_ * sizeof(CharT));
+  size_type len = size();
+  if (len <= local_capacity) {
+    pointer old_data = rep_.heap.data;
+    size_type old_cap = rep_.heap.capacity;
+    traits_type::copy(use_local(), old_data, len + 1);
+    allocator_traits_type::deallocate(allocator_, old_data, old_cap + 1);
+    size_ = len;
+  } else if (len < capacity()) {
+    reallocate(len);
   }
+}
 
-  allocator_traits_type::deallocate(allocator_, data_, capacity_);
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::iterator
+BasicString<CharT, Traits, Allocator>::erase(const_iterator pos) {
+  return erase(pos, pos + 1);
+}
 
-  data_ = new_data;
-  capacity_ = new_cap;
-  data_[size_] = '\0';
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr typename BasicString<CharT, Traits, Allocator>::iterator
+BasicString<CharT, Traits, Allocator>::erase(const_iterator first,
+                                             const_iterator last) {
+  auto pos = static_cast<size_type>(first - data_ptr());
+  erase(pos, static_cast<size_type>(last - first));
+  return data_ptr() + pos;
 }
 
 template <typename CharT, typename Traits, typename Allocator>
 inline constexpr void BasicString<CharT, Traits, Allocator>::clear() {
-  deallocate();
-  size_ = 0;
-  capacity_ = 0;
+  set_size(0);
 }
 
 template <typename T, typename Tr, typename Al>
 inline constexpr void swap(BasicString<T, Tr, Al> &lhs,
                            BasicString<T, Tr, Al> &rhs) noexcept {
-  std::swap(lhs.data_, rhs.data_);
+  std::swap(lhs.rep_, rhs.rep_);
   std::swap(lhs.size_, rhs.size_);
-  std::swap(lhs.capacity_, rhs.capacity_);
-  std::swap(lhs.allocator_, rhs.allocator_);
+  if constexpr (std::allocator_traits<
+                    Al>::propagate_on_container_swap::value) {
+    using std::swap;
+    swap(lhs.allocator_, rhs.allocator_);
+  }
+}
+
+template <typename CharT, typename Traits, size_t N, size_t M>
+inline constexpr StringConcat<CharT, Traits, N + M>
+operator+(const StringConcat<CharT, Traits, N> &lhs,
+          const StringConcat<CharT, Traits, M> &rhs) {
+  std::array<std::basic_string_view<CharT, Traits>, N + M> pieces;
+  std::copy(lhs.pieces().begin(), lhs.pieces().end(), pieces.begin());
+  std::copy(rhs.pieces().begin(), rhs.pieces().end(), pieces.begin() + N);
+  return StringConcat<CharT, Traits, N + M>(pieces);
+}
+
+template <typename CharT, typename Traits, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const StringConcat<CharT, Traits, N> &lhs, const CharT *rhs) {
+  return lhs + StringConcat<CharT, Traits, 1>(rhs);
+}
+
+template <typename CharT, typename Traits, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const CharT *lhs, const StringConcat<CharT, Traits, N> &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const StringConcat<CharT, Traits, N> &lhs,
+          std::basic_string_view<CharT, Traits> rhs) {
+  return lhs + StringConcat<CharT, Traits, 1>(rhs);
+}
+
+template <typename CharT, typename Traits, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(std::basic_string_view<CharT, Traits> lhs,
+          const StringConcat<CharT, Traits, N> &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
 }
 
-inline BasicString<char> operator"" _s(const char *str, size_t length) {
-  return BasicString<char>(str);
+// The character is viewed in place, so it has to outlive the expression
+// like every other piece.
+template <typename CharT, typename Traits, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const StringConcat<CharT, Traits, N> &lhs, const CharT &rhs) {
+  using view_type = std::basic_string_view<CharT, Traits>;
+  return lhs + StringConcat<CharT, Traits, 1>(view_type(&rhs, 1));
 }
 
-inline BasicString<wchar_t> operator"" _s(const wchar_t *str, size_t length) {
-  return BasicString<wchar_t>(str);
+template <typename CharT, typename Traits, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const CharT &lhs, const StringConcat<CharT, Traits, N> &rhs) {
+  using view_type = std::basic_string_view<CharT, Traits>;
+  return StringConcat<CharT, Traits, 1>(view_type(&lhs, 1)) + rhs;
 }
 
-inline BasicString<char16_t> operator"" _s(const char16_t *str, size_t length) {
-  return BasicString<char16_t>(str);
+template <typename CharT, typename Traits, typename Allocator, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const StringConcat<CharT, Traits, N> &lhs,
+          const BasicString<CharT, Traits, Allocator> &rhs) {
+  return lhs + StringConcat<CharT, Traits, 1>(rhs);
 }
+
+template <typename CharT, typename Traits, typename Allocator, size_t N>
+inline constexpr StringConcat<CharT, Traits, N + 1>
+operator+(const BasicString<CharT, Traits, Allocator> &lhs,
+          const StringConcat<CharT, Traits, N> &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(const BasicString<CharT, Traits, Allocator> &lhs,
+          const BasicString<CharT, Traits, Allocator> &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(const BasicString<CharT, Traits, Allocator> &lhs,
+          const CharT *rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(const CharT *lhs,
+          const BasicString<CharT, Traits, Allocator> &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(const BasicString<CharT, Traits, Allocator> &lhs,
+          std::basic_string_view<CharT, Traits> rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(std::basic_string_view<CharT, Traits> lhs,
+          const BasicString<CharT, Traits, Allocator> &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(const BasicString<CharT, Traits, Allocator> &lhs, const CharT &rhs) {
+  return StringConcat<CharT, Traits, 1>(lhs) + rhs;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr StringConcat<CharT, Traits, 2>
+operator+(const CharT &lhs, const BasicString<CharT, Traits, Allocator> &rhs) {
+  return lhs + StringConcat<CharT, Traits, 1>(rhs);
+}
+
+// Rvalue BasicString operands would dangle inside a StringConcat, so these
+// build the string straight away; a temporary on the left is appended to in
+// place, like std::string's operator+. Any operand the lvalue overloads
+// take is accepted.
+template <typename CharT, typename Traits, typename Allocator, typename Rhs>
+  requires requires(const BasicString<CharT, Traits, Allocator> &lhs,
+                    const Rhs &rhs) { lhs + rhs; }
+inline constexpr BasicString<CharT, Traits, Allocator>
+operator+(BasicString<CharT, Traits, Allocator> &&lhs, const Rhs &rhs) {
+  lhs += rhs;
+  return std::move(lhs);
+}
+
+template <typename Lhs, typename CharT, typename Traits, typename Allocator>
+  requires requires(const Lhs &lhs,
+                    const BasicString<CharT, Traits, Allocator> &rhs) {
+    lhs + rhs;
+  }
+inline constexpr BasicString<CharT, Traits, Allocator>
+operator+(const Lhs &lhs, BasicString<CharT, Traits, Allocator> &&rhs) {
+  return BasicString<CharT, Traits, Allocator>(std::as_const(lhs) +
+                                                   std::as_const(rhs),
+                                               rhs.get_allocator());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>
+operator+(BasicString<CharT, Traits, Allocator> &&lhs,
+          BasicString<CharT, Traits, Allocator> &&rhs) {
+  lhs += rhs;
+  return std::move(lhs);
+}
+
+// Transparent hasher and equality for unordered containers: BasicString,
+// string_view and const CharT* keys with the same contents hash alike, so
+// lookups do not need to build a BasicString first. Keys that carry their
+// own cached hash (see HashedString.hpp) are not rehashed.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+struct BasicStringHash {
+  using is_transparent = void;
+
+  constexpr size_t
+  operator()(std::basic_string_view<CharT, Traits> sv) const noexcept {
+    return static_cast<size_t>(string_hash::hash_chars(sv.data(), sv.size()));
+  }
+
+  template <typename Key>
+    requires requires(const Key &key) {
+      { key.hash() } -> std::convertible_to<size_t>;
+    }
+  constexpr size_t operator()(const Key &key) const noexcept {
+    return key.hash();
+  }
+};
+
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+struct BasicStringEqual {
+  using is_transparent = void;
+
+  constexpr bool
+  operator()(std::basic_string_view<CharT, Traits> lhs,
+             std::basic_string_view<CharT, Traits> rhs) const noexcept {
+    return lhs == rhs;
+  }
+};
+
+template <typename CharT, typename Traits, typename Allocator>
+struct std::hash<BasicString<CharT, Traits, Allocator>> {
+  size_t
+  operator()(const BasicString<CharT, Traits, Allocator> &str) const noexcept {
+    return BasicStringHash<CharT, Traits>()(str);
+  }
+};
+
+// BasicString over a std::pmr::memory_resource chosen at construction, e.g.
+// an ArenaResource scoped to one request.
+namespace pmr {
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+using BasicString =
+    ::BasicString<CharT, Traits, std::pmr::polymorphic_allocator<CharT>>;
+} // namespace pmr
+
+// Short literals fit the inline buffer and can initialize constexpr
+// variables; longer ones can still be built and used inside constant
+// expressions.
+inline constexpr BasicString<char> operator"" _s(const char *str,
+                                                 size_t length) {
+  return BasicString<char>(str, length);
+}
+
+inline constexpr BasicString<wchar_t> operator"" _s(const wchar_t *str,
+                                                    size_t length) {
+  return BasicString<wchar_t>(str, length);
+}
+
+inline constexpr BasicString<char16_t> operator"" _s(const char16_t *str,
+                                                     size_t length) {
+  return BasicString<char16_t>(str, length);
+}
+
+#endif
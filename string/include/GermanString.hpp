@@ -0,0 +1,524 @@
+#ifndef GERMAN_STRING_H
+#define GERMAN_STRING_H
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "BasicString.hpp"
+
+// Sixteen-byte string laid out the way the Umbra database stores its
+// strings (the "German string"): a 32-bit length, then either the whole
+// string when it is at most 12 bytes, or its first four bytes followed by
+// a pointer to all of the characters on the heap.
+//
+//   short:  | size | c0 c1 c2 c3 | c4 ... c11           |
+//   long:   | size | c0 c1 c2 c3 | pointer to c0 ... cN |
+//
+// Because the prefix is always inline, comparisons that differ in the first
+// four characters, and equality tests that differ in length or prefix,
+// finish without touching the heap; short strings never go there at all.
+// That suits sorting and joining on string columns. The unused bytes of a
+// short string are zero, so two short strings are equal exactly when their
+// 16 bytes are.
+//
+// The characters are owned and copied with the string, like BasicString.
+// They are not NUL-terminated, so there is no c_str(); data() and size()
+// or the string_view conversion give access to them. The byte-wise fast
+// paths apply to the standard traits; other traits compare through them.
+
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+class GermanString {
+  static_assert(sizeof(CharT) <= 4, "Characters must fit the prefix.");
+
+public:
+  using string_type = BasicString<CharT, Traits, Allocator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using value_type = CharT;
+  using traits_type = Traits;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using ordering = typename BasicStringOrdering<Traits>::type;
+
+  // Characters kept inline for every string, and for short ones.
+  static constexpr size_type prefix_length = 4 / sizeof(CharT);
+  static constexpr size_type inline_capacity = 12 / sizeof(CharT);
+
+  GermanString() noexcept;
+  explicit GermanString(const Allocator &alloc) noexcept;
+  GermanString(const CharT *str, const Allocator &alloc = Allocator());
+  GermanString(const CharT *str, size_type count,
+               const Allocator &alloc = Allocator());
+  explicit GermanString(view_type sv, const Allocator &alloc = Allocator());
+  template <typename StringAllocator>
+  explicit GermanString(
+      const BasicString<CharT, Traits, StringAllocator> &str,
+      const Allocator &alloc = Allocator());
+  GermanString(const GermanString &other);
+  GermanString(GermanString &&other) noexcept;
+  GermanString(std::nullptr_t) = delete;
+  ~GermanString();
+
+  GermanString &operator=(const GermanString &other);
+  GermanString &operator=(GermanString &&other) noexcept(
+      std::allocator_traits<Allocator>::propagate_on_container_move_assignment::
+          value ||
+      std::allocator_traits<Allocator>::is_always_equal::value);
+
+  Allocator get_allocator() const;
+
+  const CharT *data() const noexcept;
+  size_type size() const noexcept;
+  bool empty() const noexcept;
+  static constexpr size_type max_size() noexcept {
+    return std::numeric_limits<uint32_t>::max();
+  }
+  // True when the characters are stored in the object itself.
+  bool is_inline() const noexcept;
+  // The first min(size(), prefix_length) characters.
+  view_type prefix() const noexcept;
+  const CharT &operator[](size_type index) const;
+  operator view_type() const noexcept;
+
+  // Copies the characters into a BasicString with the same allocator.
+  string_type str() const;
+  explicit operator string_type() const;
+
+  int compare(const GermanString &other) const noexcept;
+  int compare(view_type other) const noexcept;
+
+  void swap(GermanString &other) noexcept;
+
+  bool operator==(const GermanString &other) const noexcept;
+  template <typename StringAllocator>
+  bool operator==(
+      const BasicString<CharT, Traits, StringAllocator> &other) const noexcept;
+  bool operator==(view_type other) const noexcept;
+  bool operator==(const CharT *other) const;
+  ordering operator<=>(const GermanString &other) const noexcept;
+  template <typename StringAllocator>
+  ordering operator<=>(
+      const BasicString<CharT, Traits, StringAllocator> &other) const noexcept;
+  ordering operator<=>(view_type other) const noexcept;
+  ordering operator<=>(const CharT *other) const;
+
+private:
+  using allocator_traits_type = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same_v<typename allocator_traits_type::pointer,
+                               CharT *>,
+                "The allocator must hand out plain pointers.");
+
+  struct short_rep {
+    uint32_t size;
+    CharT chars[inline_capacity];
+  };
+
+  struct long_rep {
+    uint32_t size;
+    CharT prefix[prefix_length];
+    CharT *data;
+  };
+
+  // Both members start with the size, which is read through either.
+  union rep {
+    short_rep local;
+    long_rep heap;
+  };
+
+  // Equal characters are equal bytes.
+  static constexpr bool bitwise_equal =
+      std::is_same_v<Traits, std::char_traits<CharT>>;
+  // ...and bytes order like the characters, compared as unsigned.
+  static constexpr bool byte_order = bitwise_equal && sizeof(CharT) == 1;
+
+  static uint32_t prefix_key(const CharT *str, size_type len) noexcept;
+  static int compare_chars(uint32_t lhs_key, const CharT *lhs,
+                           size_type lhs_len, uint32_t rhs_key,
+                           const CharT *rhs, size_type rhs_len) noexcept;
+  uint64_t head() const noexcept;
+  uint64_t tail() const noexcept;
+  void init(const CharT *str, size_type len);
+  void release() noexcept;
+  void adopt(GermanString &other) noexcept;
+
+  rep rep_;
+  [[no_unique_address]] allocator_type allocator_;
+};
+
+// The prefix as a big-endian number, zero-padded past the end of a short
+// string, so comparing two keys orders the strings by their first bytes.
+template <typename CharT, typename Traits, typename Allocator>
+inline uint32_t
+GermanString<CharT, Traits, Allocator>::prefix_key(const CharT *str,
+                                                   size_type len) noexcept {
+  uint32_t key = 0;
+  std::memcpy(&key, str, std::min<size_type>(len, 4));
+  if constexpr (std::endian::native == std::endian::little)
+    key = __builtin_bswap32(key);
+  return key;
+}
+
+// Used with byte_order only: the keys settle the first four bytes, and the
+// characters after them are compared only when the keys tie.
+template <typename CharT, typename Traits, typename Allocator>
+inline int GermanString<CharT, Traits, Allocator>::compare_chars(
+    uint32_t lhs_key, const CharT *lhs, size_type lhs_len, uint32_t rhs_key,
+    const CharT *rhs, size_type rhs_len) noexcept {
+  if (lhs_key != rhs_key)
+    return lhs_key < rhs_key ? -1 : 1;
+
+  size_type len = std::min(lhs_len, rhs_len);
+  if (len > prefix_length) {
+    int result = traits_type::compare(lhs + prefix_length,
+                                      rhs + prefix_length,
+                                      len - prefix_length);
+    if (result != 0)
+      return result;
+  }
+  return lhs_len < rhs_len ? -1 : (lhs_len > rhs_len ? 1 : 0);
+}
+
+// The size and the prefix, which sit at the same place in both layouts.
+template <typename CharT, typename Traits, typename Allocator>
+inline uint64_t
+GermanString<CharT, Traits, Allocator>::head() const noexcept {
+  uint64_t word;
+  std::memcpy(&word, &rep_, sizeof(word));
+  return word;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline uint64_t
+GermanString<CharT, Traits, Allocator>::tail() const noexcept {
+  uint64_t word;
+  std::memcpy(&word, reinterpret_cast<const char *>(&rep_) + 8, sizeof(word));
+  return word;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void GermanString<CharT, Traits, Allocator>::init(const CharT *str,
+                                                         size_type len) {
+  if (len > max_size()) {
+    throw std::length_error("GermanString: requested size exceeds max_size()");
+  }
+
+  if (len <= inline_capacity) {
+    rep_.local.size = static_cast<uint32_t>(len);
+    traits_type::copy(rep_.local.chars, str, len);
+    return;
+  }
+
+  CharT *chars = allocator_traits_type::allocate(allocator_, len);
+  traits_type::copy(chars, str, len);
+  rep_.heap.size = static_cast<uint32_t>(len);
+  traits_type::copy(rep_.heap.prefix, str, prefix_length);
+  rep_.heap.data = chars;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void GermanString<CharT, Traits, Allocator>::release() noexcept {
+  if (!is_inline())
+    allocator_traits_type::deallocate(allocator_, rep_.heap.data, size());
+  rep_ = rep();
+}
+
+// Takes other's characters, which must come from an allocator equal to
+// ours once the assignment is done.
+template <typename CharT, typename Traits, typename Allocator>
+inline void
+GermanString<CharT, Traits, Allocator>::adopt(GermanString &other) noexcept {
+  release();
+  rep_ = std::exchange(other.rep_, rep());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString() noexcept
+    : rep_() {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    const Allocator &alloc) noexcept
+    : rep_(), allocator_(alloc) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    const CharT *str, const Allocator &alloc)
+    : rep_(), allocator_(alloc) {
+  init(str, traits_type::length(str));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    const CharT *str, size_type count, const Allocator &alloc)
+    : rep_(), allocator_(alloc) {
+  init(str, count);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    view_type sv, const Allocator &alloc)
+    : rep_(), allocator_(alloc) {
+  init(sv.data(), sv.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <typename StringAllocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    const BasicString<CharT, Traits, StringAllocator> &str,
+    const Allocator &alloc)
+    : rep_(), allocator_(alloc) {
+  init(str.data(), str.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    const GermanString &other)
+    : rep_(other.rep_),
+      allocator_(allocator_traits_type::select_on_container_copy_construction(
+          other.allocator_)) {
+  if (!is_inline()) {
+    CharT *chars = allocator_traits_type::allocate(allocator_, size());
+    traits_type::copy(chars, other.rep_.heap.data, size());
+    rep_.heap.data = chars;
+  }
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::GermanString(
+    GermanString &&other) noexcept
+    : rep_(std::exchange(other.rep_, rep())), allocator_(other.allocator_) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::~GermanString() {
+  release();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator> &
+GermanString<CharT, Traits, Allocator>::operator=(const GermanString &other) {
+  if (this == &other)
+    return *this;
+
+  constexpr bool propagate =
+      allocator_traits_type::propagate_on_container_copy_assignment::value;
+  GermanString copy(other.data(), other.size(),
+                    propagate ? other.allocator_ : allocator_);
+  adopt(copy);
+  if constexpr (propagate)
+    allocator_ = other.allocator_;
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator> &
+GermanString<CharT, Traits, Allocator>::operator=(GermanString &&other)
+    noexcept(
+        allocator_traits_type::propagate_on_container_move_assignment::value ||
+        allocator_traits_type::is_always_equal::value) {
+  if (this == &other)
+    return *this;
+
+  if constexpr (!allocator_traits_type::propagate_on_container_move_assignment::
+                    value &&
+                !allocator_traits_type::is_always_equal::value) {
+    // The buffer belongs to an allocator we cannot take over, so copy.
+    if (allocator_ != other.allocator_) {
+      GermanString copy(other.data(), other.size(), allocator_);
+      adopt(copy);
+      return *this;
+    }
+  }
+
+  adopt(other);
+  if constexpr (allocator_traits_type::propagate_on_container_move_assignment::
+                    value)
+    allocator_ = std::move(other.allocator_);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Allocator GermanString<CharT, Traits, Allocator>::get_allocator() const {
+  return allocator_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const CharT *
+GermanString<CharT, Traits, Allocator>::data() const noexcept {
+  return is_inline() ? rep_.local.chars : rep_.heap.data;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename GermanString<CharT, Traits, Allocator>::size_type
+GermanString<CharT, Traits, Allocator>::size() const noexcept {
+  return rep_.local.size;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool GermanString<CharT, Traits, Allocator>::empty() const noexcept {
+  return rep_.local.size == 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool
+GermanString<CharT, Traits, Allocator>::is_inline() const noexcept {
+  return rep_.local.size <= inline_capacity;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename GermanString<CharT, Traits, Allocator>::view_type
+GermanString<CharT, Traits, Allocator>::prefix() const noexcept {
+  const CharT *chars = is_inline() ? rep_.local.chars : rep_.heap.prefix;
+  return view_type(chars, std::min(size(), prefix_length));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const CharT &
+GermanString<CharT, Traits, Allocator>::operator[](size_type index) const {
+  return data()[index];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::operator view_type()
+    const noexcept {
+  return view_type(data(), size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename GermanString<CharT, Traits, Allocator>::string_type
+GermanString<CharT, Traits, Allocator>::str() const {
+  return string_type(data(), size(), allocator_);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline GermanString<CharT, Traits, Allocator>::operator string_type() const {
+  return str();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline int GermanString<CharT, Traits, Allocator>::compare(
+    const GermanString &other) const noexcept {
+  if constexpr (byte_order) {
+    const CharT *lhs = is_inline() ? rep_.local.chars : rep_.heap.prefix;
+    const CharT *rhs =
+        other.is_inline() ? other.rep_.local.chars : other.rep_.heap.prefix;
+    return compare_chars(prefix_key(lhs, prefix_length), data(), size(),
+                         prefix_key(rhs, prefix_length), other.data(),
+                         other.size());
+  }
+  return view_type(*this).compare(view_type(other));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline int GermanString<CharT, Traits, Allocator>::compare(
+    view_type other) const noexcept {
+  if constexpr (byte_order) {
+    const CharT *lhs = is_inline() ? rep_.local.chars : rep_.heap.prefix;
+    return compare_chars(prefix_key(lhs, prefix_length), data(), size(),
+                         prefix_key(other.data(), other.size()), other.data(),
+                         other.size());
+  }
+  return view_type(*this).compare(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void
+GermanString<CharT, Traits, Allocator>::swap(GermanString &other) noexcept {
+  std::swap(rep_, other.rep_);
+  if constexpr (allocator_traits_type::propagate_on_container_swap::value) {
+    using std::swap;
+    swap(allocator_, other.allocator_);
+  }
+}
+
+// Different sizes or prefixes are told apart from the first eight bytes;
+// short strings are then settled by the other eight.
+template <typename CharT, typename Traits, typename Allocator>
+inline bool GermanString<CharT, Traits, Allocator>::operator==(
+    const GermanString &other) const noexcept {
+  if constexpr (bitwise_equal) {
+    if (head() != other.head())
+      return false;
+    if (is_inline())
+      return tail() == other.tail();
+    return traits_type::compare(rep_.heap.data + prefix_length,
+                                other.rep_.heap.data + prefix_length,
+                                size() - prefix_length) == 0;
+  }
+  return view_type(*this) == view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <typename StringAllocator>
+inline bool GermanString<CharT, Traits, Allocator>::operator==(
+    const BasicString<CharT, Traits, StringAllocator> &other) const noexcept {
+  return *this == view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool GermanString<CharT, Traits, Allocator>::operator==(
+    view_type other) const noexcept {
+  if (size() != other.size())
+    return false;
+  return compare(other) == 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool
+GermanString<CharT, Traits, Allocator>::operator==(const CharT *other) const {
+  return *this == view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename GermanString<CharT, Traits, Allocator>::ordering
+GermanString<CharT, Traits, Allocator>::operator<=>(
+    const GermanString &other) const noexcept {
+  return static_cast<ordering>(compare(other) <=> 0);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <typename StringAllocator>
+inline typename GermanString<CharT, Traits, Allocator>::ordering
+GermanString<CharT, Traits, Allocator>::operator<=>(
+    const BasicString<CharT, Traits, StringAllocator> &other) const noexcept {
+  return *this <=> view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename GermanString<CharT, Traits, Allocator>::ordering
+GermanString<CharT, Traits, Allocator>::operator<=>(
+    view_type other) const noexcept {
+  return static_cast<ordering>(compare(other) <=> 0);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename GermanString<CharT, Traits, Allocator>::ordering
+GermanString<CharT, Traits, Allocator>::operator<=>(const CharT *other) const {
+  return *this <=> view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void swap(GermanString<CharT, Traits, Allocator> &lhs,
+                 GermanString<CharT, Traits, Allocator> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+struct std::hash<GermanString<CharT, Traits, Allocator>> {
+  size_t operator()(
+      const GermanString<CharT, Traits, Allocator> &str) const noexcept {
+    return BasicStringHash<CharT, Traits>()(str);
+  }
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef HASHED_STRING_H
+#define HASHED_STRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include "BasicString.hpp"
+
+// BasicString that remembers its hash. The hash is computed on the first
+// call to hash() and reused until the string is modified, so keys that are
+// rehashed on every table growth are hashed once. All mutation goes through
+// modify() or the forwarding helpers, which drop the cached value.
+//
+// The cache is atomic: hash() may be called concurrently on a shared const
+// object.
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+class HashedString {
+public:
+  using string_type = BasicString<CharT, Traits, Allocator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using size_type = typename string_type::size_type;
+
+  HashedString() = default;
+  HashedString(const CharT *str);
+  explicit HashedString(view_type sv);
+  HashedString(string_type str);
+  HashedString(const HashedString &other);
+  HashedString(HashedString &&other) noexcept;
+
+  HashedString &operator=(const HashedString &other);
+  HashedString &operator=(HashedString &&other) noexcept;
+
+  const string_type &str() const;
+  const CharT *data() const;
+  size_type size() const;
+  bool empty() const;
+  operator view_type() const noexcept;
+
+  size_t hash() const noexcept;
+
+  // Runs edit(string_type &) and invalidates the cached hash.
+  template <typename Edit> void modify(Edit &&edit);
+  HashedString &append(view_type sv);
+  void push_back(CharT ch);
+  void clear();
+
+  bool operator==(const HashedString &other) const;
+  bool operator==(view_type other) const;
+
+private:
+  void copy_cache(const HashedString &other) noexcept;
+
+  string_type str_;
+  mutable std::atomic<size_t> hash_{0};
+  mutable std::atomic<bool> cached_{false};
+};
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator>::HashedString(const CharT *str)
+    : str_(str) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator>::HashedString(view_type sv)
+    : str_(sv) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator>::HashedString(string_type str)
+    : str_(std::move(str)) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator>::HashedString(
+    const HashedString &other)
+    : str_(other.str_) {
+  copy_cache(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator>::HashedString(
+    HashedString &&other) noexcept
+    : str_(std::move(other.str_)) {
+  copy_cache(other);
+  other.cached_.store(false, std::memory_order_relaxed);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator> &
+HashedString<CharT, Traits, Allocator>::operator=(const HashedString &other) {
+  if (this != &other) {
+    str_ = other.str_;
+    copy_cache(other);
+  }
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator> &
+HashedString<CharT, Traits, Allocator>::operator=(
+    HashedString &&other) noexcept {
+  if (this != &other) {
+    str_ = std::move(other.str_);
+    copy_cache(other);
+    other.cached_.store(false, std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void HashedString<CharT, Traits, Allocator>::copy_cache(
+    const HashedString &other) noexcept {
+  bool cached = other.cached_.load(std::memory_order_acquire);
+  hash_.store(other.hash_.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+  cached_.store(cached, std::memory_order_release);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const typename HashedString<CharT, Traits, Allocator>::string_type &
+HashedString<CharT, Traits, Allocator>::str() const {
+  return str_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const CharT *HashedString<CharT, Traits, Allocator>::data() const {
+  return str_.data();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename HashedString<CharT, Traits, Allocator>::size_type
+HashedString<CharT, Traits, Allocator>::size() const {
+  return str_.size();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool HashedString<CharT, Traits, Allocator>::empty() const {
+  return str_.empty();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator>::operator view_type()
+    const noexcept {
+  return str_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline size_t HashedString<CharT, Traits, Allocator>::hash() const noexcept {
+  if (cached_.load(std::memory_order_acquire))
+    return hash_.load(std::memory_order_relaxed);
+
+  size_t h = BasicStringHash<CharT, Traits>()(view_type(str_));
+  hash_.store(h, std::memory_order_relaxed);
+  cached_.store(true, std::memory_order_release);
+  return h;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <typename Edit>
+inline void HashedString<CharT, Traits, Allocator>::modify(Edit &&edit) {
+  cached_.store(false, std::memory_order_relaxed);
+  std::forward<Edit>(edit)(str_);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline HashedString<CharT, Traits, Allocator> &
+HashedString<CharT, Traits, Allocator>::append(view_type sv) {
+  modify([&](string_type &str) { str.append(sv); });
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void HashedString<CharT, Traits, Allocator>::push_back(CharT ch) {
+  modify([&](string_type &str) { str.push_back(ch); });
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void HashedString<CharT, Traits, Allocator>::clear() {
+  modify([](string_type &str) { str.clear(); });
+}
+
+// Two cached hashes that differ settle the comparison without touching the
+// characters.
+template <typename CharT, typename Traits, typename Allocator>
+inline bool HashedString<CharT, Traits, Allocator>::operator==(
+    const HashedString &other) const {
+  if (str_.size() != other.str_.size())
+    return false;
+  if (cached_.load(std::memory_order_acquire) &&
+      other.cached_.load(std::memory_order_acquire) &&
+      hash_.load(std::memory_order_relaxed) !=
+          other.hash_.load(std::memory_order_relaxed))
+    return false;
+  return str_ == other.str_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool
+HashedString<CharT, Traits, Allocator>::operator==(view_type other) const {
+  return str_ == other;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+struct std::hash<HashedString<CharT, Traits, Allocator>> {
+  size_t
+  operator()(const HashedString<CharT, Traits, Allocator> &str) const noexcept {
+    return str.hash();
+  }
+};
+
+#endif
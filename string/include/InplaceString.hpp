@@ -0,0 +1,660 @@
+#ifndef INPLACE_STRING_H
+#define INPLACE_STRING_H
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "BasicString.hpp"
+#include "StringSearch.hpp"
+
+// Fixed-capacity string for short keys with a known upper bound: ticker
+// symbols, ISO codes, fixed-width IDs. Up to N characters and a NUL live in
+// the object itself, next to a length counter of the smallest unsigned type
+// that holds N, so InplaceString<7> is 9 bytes and never allocates.
+//
+// The object is trivially copyable and holds no pointers, so it can be
+// copied with memcpy, placed in shared memory or a memory-mapped file, and
+// used in constant expressions. The characters past size() are kept zero,
+// which makes two equal strings equal byte for byte; with the length that
+// lets std::atomic<InplaceString<N>> compare-and-swap values (lock-free
+// where the object is 8 bytes, as InplaceString<6> is). Growing past N throws
+// std::length_error.
+//
+// The interface follows BasicString, and conversions in either direction
+// copy the characters once: str() builds a BasicString of exactly size()
+// characters, and an InplaceBasicString is constructed straight from a
+// BasicString, a view or a _s literal.
+
+namespace inplace_string {
+
+// Smallest unsigned type that counts up to N.
+template <size_t N>
+using length_type = std::conditional_t<
+    N <= UINT8_MAX, uint8_t,
+    std::conditional_t<N <= UINT16_MAX, uint16_t,
+                       std::conditional_t<N <= UINT32_MAX, uint32_t,
+                                          size_t>>>;
+
+} // namespace inplace_string
+
+template <typename CharT, size_t N, typename Traits = std::char_traits<CharT>>
+class InplaceBasicString {
+public:
+  using value_type = CharT;
+  using traits_type = Traits;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = CharT *;
+  using const_pointer = const CharT *;
+  using reference = CharT &;
+  using const_reference = const CharT &;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using length_type = inplace_string::length_type<N>;
+  using ordering = typename BasicStringOrdering<Traits>::type;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  /* constructor */
+  constexpr InplaceBasicString() noexcept = default;
+  constexpr InplaceBasicString(const CharT *str);
+  constexpr InplaceBasicString(const CharT *str, size_type count);
+  constexpr explicit InplaceBasicString(view_type sv);
+  template <typename Allocator>
+  constexpr explicit InplaceBasicString(
+      const BasicString<CharT, Traits, Allocator> &str);
+  constexpr InplaceBasicString(size_type n, CharT ch);
+  InplaceBasicString(std::nullptr_t) = delete;
+
+  /* element access */
+  constexpr const_pointer c_str() const noexcept;
+  constexpr const_pointer data() const noexcept;
+  constexpr pointer data() noexcept;
+  constexpr const_reference operator[](size_type index) const;
+  constexpr reference operator[](size_type index);
+  constexpr const_reference at(size_type index) const;
+  constexpr reference at(size_type index);
+  constexpr operator view_type() const noexcept;
+
+  // Copies the characters into a BasicString, allocating at most once.
+  template <typename Allocator = std::allocator<CharT>>
+  constexpr BasicString<CharT, Traits, Allocator>
+  str(const Allocator &alloc = Allocator()) const;
+  template <typename Allocator>
+  constexpr explicit operator BasicString<CharT, Traits, Allocator>() const;
+
+  /* iterators */
+  constexpr iterator begin() noexcept;
+  constexpr const_iterator begin() const noexcept;
+  constexpr const_iterator cbegin() const noexcept;
+  constexpr iterator end() noexcept;
+  constexpr const_iterator end() const noexcept;
+  constexpr const_iterator cend() const noexcept;
+  constexpr reverse_iterator rbegin() noexcept;
+  constexpr const_reverse_iterator rbegin() const noexcept;
+  constexpr reverse_iterator rend() noexcept;
+  constexpr const_reverse_iterator rend() const noexcept;
+
+  /* capacity */
+  constexpr size_type size() const noexcept;
+  constexpr size_type length() const noexcept;
+  constexpr bool empty() const noexcept;
+  static constexpr size_type capacity() noexcept { return N; }
+  static constexpr size_type max_size() noexcept { return N; }
+
+  /* modifiers */
+  constexpr void pop_back();
+  constexpr void push_back(CharT ch);
+  constexpr InplaceBasicString &append(view_type sv);
+  constexpr InplaceBasicString &append(const CharT *str);
+  constexpr InplaceBasicString &append(const CharT *str, size_type count);
+  constexpr InplaceBasicString &append(size_type count, CharT ch);
+  constexpr InplaceBasicString &operator+=(view_type sv);
+  constexpr InplaceBasicString &operator+=(const CharT *str);
+  constexpr InplaceBasicString &operator+=(CharT ch);
+  constexpr void replace(size_type pos, size_type len, view_type sv);
+  constexpr void resize(size_type count, CharT ch);
+  constexpr void erase(size_type pos, size_type len);
+  constexpr iterator erase(const_iterator pos);
+  constexpr iterator erase(const_iterator first, const_iterator last);
+  constexpr void clear() noexcept;
+  constexpr void swap(InplaceBasicString &other) noexcept;
+
+  /* search */
+  constexpr size_type find(view_type sub, size_type pos = 0) const;
+  constexpr size_type find(const CharT *sub, size_type pos = 0) const;
+  constexpr size_type find(CharT ch, size_type pos = 0) const;
+
+  /* operations */
+  constexpr int compare(view_type other) const;
+  constexpr int compare(const CharT *other) const;
+  constexpr bool starts_with(view_type prefix) const;
+  constexpr bool starts_with(CharT ch) const;
+  constexpr bool ends_with(view_type suffix) const;
+  constexpr bool ends_with(CharT ch) const;
+
+  constexpr bool operator==(const InplaceBasicString &other) const noexcept;
+  template <typename Allocator>
+  constexpr bool
+  operator==(const BasicString<CharT, Traits, Allocator> &other) const;
+  constexpr bool operator==(view_type other) const;
+  constexpr bool operator==(const CharT *other) const;
+  constexpr ordering operator<=>(const InplaceBasicString &other) const;
+  template <typename Allocator>
+  constexpr ordering
+  operator<=>(const BasicString<CharT, Traits, Allocator> &other) const;
+  constexpr ordering operator<=>(view_type other) const;
+  constexpr ordering operator<=>(const CharT *other) const;
+
+private:
+  static constexpr void check_length(size_type len);
+  constexpr void check_room(size_type count) const;
+  constexpr void assign_chars(const CharT *str, size_type len);
+  constexpr void set_size(size_type len) noexcept;
+
+  // chars_[size_] is the NUL; every character after it is zero as well.
+  CharT chars_[N + 1] = {};
+  length_type size_ = 0;
+};
+
+template <size_t N>
+using InplaceString = InplaceBasicString<char, N>;
+template <size_t N>
+using InplaceWString = InplaceBasicString<wchar_t, N>;
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::check_length(size_type len) {
+  if (len > N) {
+    throw std::length_error(
+        "InplaceBasicString: requested size exceeds capacity()");
+  }
+}
+
+// Throws unless count more characters fit after the current ones.
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::check_room(size_type count) const {
+  check_length(count > N - size() ? npos : size() + count);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::assign_chars(const CharT *str,
+                                                   size_type len) {
+  check_length(len);
+  traits_type::copy(chars_, str, len);
+  size_ = static_cast<length_type>(len);
+}
+
+// Growing writes the new characters before calling this; shrinking clears
+// the ones that drop off the end, so everything past the NUL stays zero.
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::set_size(size_type len) noexcept {
+  if (len < size_)
+    traits_type::assign(chars_ + len, size_ - len, CharT());
+  size_ = static_cast<length_type>(len);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits>::InplaceBasicString(
+    const CharT *str) {
+  assign_chars(str, traits_type::length(str));
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits>::InplaceBasicString(
+    const CharT *str, size_type count) {
+  assign_chars(str, count);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits>::InplaceBasicString(
+    view_type sv) {
+  assign_chars(sv.data(), sv.size());
+}
+
+template <typename CharT, size_t N, typename Traits>
+template <typename Allocator>
+inline constexpr InplaceBasicString<CharT, N, Traits>::InplaceBasicString(
+    const BasicString<CharT, Traits, Allocator> &str) {
+  assign_chars(str.data(), str.size());
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits>::InplaceBasicString(
+    size_type n, CharT ch) {
+  check_length(n);
+  traits_type::assign(chars_, n, ch);
+  size_ = static_cast<length_type>(n);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_pointer
+InplaceBasicString<CharT, N, Traits>::c_str() const noexcept {
+  return chars_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_pointer
+InplaceBasicString<CharT, N, Traits>::data() const noexcept {
+  return chars_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::pointer
+InplaceBasicString<CharT, N, Traits>::data() noexcept {
+  return chars_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_reference
+InplaceBasicString<CharT, N, Traits>::operator[](size_type index) const {
+  return chars_[index];
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::reference
+InplaceBasicString<CharT, N, Traits>::operator[](size_type index) {
+  return chars_[index];
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_reference
+InplaceBasicString<CharT, N, Traits>::at(size_type index) const {
+  if (index >= size()) {
+    throw std::out_of_range("InplaceBasicString::at: position out of range");
+  }
+  return chars_[index];
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::reference
+InplaceBasicString<CharT, N, Traits>::at(size_type index) {
+  if (index >= size()) {
+    throw std::out_of_range("InplaceBasicString::at: position out of range");
+  }
+  return chars_[index];
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits>::operator view_type()
+    const noexcept {
+  return view_type(chars_, size_);
+}
+
+template <typename CharT, size_t N, typename Traits>
+template <typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>
+InplaceBasicString<CharT, N, Traits>::str(const Allocator &alloc) const {
+  return BasicString<CharT, Traits, Allocator>(chars_, size_, alloc);
+}
+
+template <typename CharT, size_t N, typename Traits>
+template <typename Allocator>
+inline constexpr InplaceBasicString<CharT, N, Traits>::
+operator BasicString<CharT, Traits, Allocator>() const {
+  return str<Allocator>();
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::iterator
+InplaceBasicString<CharT, N, Traits>::begin() noexcept {
+  return chars_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_iterator
+InplaceBasicString<CharT, N, Traits>::begin() const noexcept {
+  return chars_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_iterator
+InplaceBasicString<CharT, N, Traits>::cbegin() const noexcept {
+  return chars_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::iterator
+InplaceBasicString<CharT, N, Traits>::end() noexcept {
+  return chars_ + size_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_iterator
+InplaceBasicString<CharT, N, Traits>::end() const noexcept {
+  return chars_ + size_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::const_iterator
+InplaceBasicString<CharT, N, Traits>::cend() const noexcept {
+  return chars_ + size_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr
+    typename InplaceBasicString<CharT, N, Traits>::reverse_iterator
+    InplaceBasicString<CharT, N, Traits>::rbegin() noexcept {
+  return reverse_iterator(end());
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr
+    typename InplaceBasicString<CharT, N, Traits>::const_reverse_iterator
+    InplaceBasicString<CharT, N, Traits>::rbegin() const noexcept {
+  return const_reverse_iterator(end());
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr
+    typename InplaceBasicString<CharT, N, Traits>::reverse_iterator
+    InplaceBasicString<CharT, N, Traits>::rend() noexcept {
+  return reverse_iterator(begin());
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr
+    typename InplaceBasicString<CharT, N, Traits>::const_reverse_iterator
+    InplaceBasicString<CharT, N, Traits>::rend() const noexcept {
+  return const_reverse_iterator(begin());
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::size_type
+InplaceBasicString<CharT, N, Traits>::size() const noexcept {
+  return size_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::size_type
+InplaceBasicString<CharT, N, Traits>::length() const noexcept {
+  return size_;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool InplaceBasicString<CharT, N, Traits>::empty() const
+    noexcept {
+  return size_ == 0;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void InplaceBasicString<CharT, N, Traits>::pop_back() {
+  set_size(size() - 1);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::push_back(CharT ch) {
+  append(1, ch);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::append(view_type sv) {
+  return append(sv.data(), sv.size());
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::append(const CharT *str) {
+  return append(str, traits_type::length(str));
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::append(const CharT *str,
+                                             size_type count) {
+  check_room(count);
+  traits_type::move(chars_ + size_, str, count);
+  size_ = static_cast<length_type>(size_ + count);
+  return *this;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::append(size_type count, CharT ch) {
+  check_room(count);
+  traits_type::assign(chars_ + size_, count, ch);
+  size_ = static_cast<length_type>(size_ + count);
+  return *this;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::operator+=(view_type sv) {
+  return append(sv);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::operator+=(const CharT *str) {
+  return append(str);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr InplaceBasicString<CharT, N, Traits> &
+InplaceBasicString<CharT, N, Traits>::operator+=(CharT ch) {
+  return append(1, ch);
+}
+
+// Assembled in a second buffer, which also covers sources that are views of
+// this string.
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::replace(size_type pos, size_type len,
+                                              view_type sv) {
+  size_type old_size = size();
+  if (pos > old_size) {
+    throw std::out_of_range("Position is out of range.");
+  }
+
+  len = std::min(len, old_size - pos);
+  size_type tail = old_size - pos - len;
+  check_length(old_size - len + sv.size());
+
+  InplaceBasicString result;
+  traits_type::copy(result.chars_, chars_, pos);
+  traits_type::copy(result.chars_ + pos, sv.data(), sv.size());
+  traits_type::copy(result.chars_ + pos + sv.size(), chars_ + pos + len, tail);
+  result.size_ = static_cast<length_type>(pos + sv.size() + tail);
+  *this = result;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::resize(size_type count, CharT ch) {
+  size_type len = size();
+  if (count > len) {
+    check_length(count);
+    traits_type::assign(chars_ + len, count - len, ch);
+  }
+  set_size(count);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::erase(size_type pos, size_type len) {
+  size_type old_size = size();
+  if (pos > old_size) {
+    throw std::out_of_range("Position is out of range.");
+  }
+
+  len = std::min(len, old_size - pos);
+  traits_type::move(chars_ + pos, chars_ + pos + len, old_size - pos - len);
+  set_size(old_size - len);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::iterator
+InplaceBasicString<CharT, N, Traits>::erase(const_iterator pos) {
+  return erase(pos, pos + 1);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::iterator
+InplaceBasicString<CharT, N, Traits>::erase(const_iterator first,
+                                            const_iterator last) {
+  size_type pos = static_cast<size_type>(first - chars_);
+  erase(pos, static_cast<size_type>(last - first));
+  return chars_ + pos;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void InplaceBasicString<CharT, N, Traits>::clear() noexcept {
+  set_size(0);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void
+InplaceBasicString<CharT, N, Traits>::swap(InplaceBasicString &other) noexcept {
+  InplaceBasicString copy = *this;
+  *this = other;
+  other = copy;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::size_type
+InplaceBasicString<CharT, N, Traits>::find(view_type sub,
+                                           size_type pos) const {
+  if (pos > size())
+    return npos;
+
+  size_type found = string_search::find<CharT, Traits>(
+      chars_ + pos, size() - pos, sub.data(), sub.size());
+  return found == string_search::npos ? npos : found + pos;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::size_type
+InplaceBasicString<CharT, N, Traits>::find(const CharT *sub,
+                                           size_type pos) const {
+  return find(view_type(sub), pos);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::size_type
+InplaceBasicString<CharT, N, Traits>::find(CharT ch, size_type pos) const {
+  if (pos >= size())
+    return npos;
+
+  const CharT *p = traits_type::find(chars_ + pos, size() - pos, ch);
+  return p ? static_cast<size_type>(p - chars_) : npos;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr int
+InplaceBasicString<CharT, N, Traits>::compare(view_type other) const {
+  return view_type(*this).compare(other);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr int
+InplaceBasicString<CharT, N, Traits>::compare(const CharT *other) const {
+  return compare(view_type(other));
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool
+InplaceBasicString<CharT, N, Traits>::starts_with(view_type prefix) const {
+  return view_type(*this).starts_with(prefix);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool
+InplaceBasicString<CharT, N, Traits>::starts_with(CharT ch) const {
+  return size_ != 0 && traits_type::eq(chars_[0], ch);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool
+InplaceBasicString<CharT, N, Traits>::ends_with(view_type suffix) const {
+  return view_type(*this).ends_with(suffix);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool
+InplaceBasicString<CharT, N, Traits>::ends_with(CharT ch) const {
+  return size_ != 0 && traits_type::eq(chars_[size_ - 1], ch);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool InplaceBasicString<CharT, N, Traits>::operator==(
+    const InplaceBasicString &other) const noexcept {
+  return size_ == other.size_ &&
+         traits_type::compare(chars_, other.chars_, size_) == 0;
+}
+
+template <typename CharT, size_t N, typename Traits>
+template <typename Allocator>
+inline constexpr bool InplaceBasicString<CharT, N, Traits>::operator==(
+    const BasicString<CharT, Traits, Allocator> &other) const {
+  return view_type(*this) == view_type(other);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool
+InplaceBasicString<CharT, N, Traits>::operator==(view_type other) const {
+  return view_type(*this) == other;
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr bool
+InplaceBasicString<CharT, N, Traits>::operator==(const CharT *other) const {
+  return view_type(*this) == view_type(other);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::ordering
+InplaceBasicString<CharT, N, Traits>::operator<=>(
+    const InplaceBasicString &other) const {
+  return *this <=> view_type(other);
+}
+
+template <typename CharT, size_t N, typename Traits>
+template <typename Allocator>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::ordering
+InplaceBasicString<CharT, N, Traits>::operator<=>(
+    const BasicString<CharT, Traits, Allocator> &other) const {
+  return *this <=> view_type(other);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::ordering
+InplaceBasicString<CharT, N, Traits>::operator<=>(view_type other) const {
+  return static_cast<ordering>(compare(other) <=> 0);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr typename InplaceBasicString<CharT, N, Traits>::ordering
+InplaceBasicString<CharT, N, Traits>::operator<=>(const CharT *other) const {
+  return *this <=> view_type(other);
+}
+
+template <typename CharT, size_t N, typename Traits>
+inline constexpr void swap(InplaceBasicString<CharT, N, Traits> &lhs,
+                           InplaceBasicString<CharT, N, Traits> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename CharT, size_t N, typename Traits>
+struct std::hash<InplaceBasicString<CharT, N, Traits>> {
+  size_t operator()(
+      const InplaceBasicString<CharT, N, Traits> &str) const noexcept {
+    return BasicStringHash<CharT, Traits>()(str);
+  }
+};
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef INTERN_POOL_H
+#define INTERN_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "ArenaResource.hpp"
+#include "BasicString.hpp"
+
+namespace string_intern {
+
+// One interned string: its hash and length, followed by size + 1
+// characters, the last one a NUL. Entries never move or go away while their
+// pool is alive.
+template <typename CharT> struct Entry {
+  size_t hash;
+  size_t size;
+
+  const CharT *chars() const noexcept {
+    return reinterpret_cast<const CharT *>(this + 1);
+  }
+};
+
+} // namespace string_intern
+
+// Handle to a string interned in a BasicInternPool. Two symbols from the
+// same pool are equal exactly when their strings are, so equality is a
+// pointer comparison and hashing reads the hash stored at interning time.
+// The default symbol is the empty string. A symbol is valid as long as the
+// pool that produced it.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class Symbol {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  constexpr Symbol() noexcept = default;
+
+  const CharT *data() const noexcept;
+  const CharT *c_str() const noexcept;
+  size_t size() const noexcept;
+  bool empty() const noexcept;
+  view_type view() const noexcept;
+  operator view_type() const noexcept;
+
+  // Same value BasicStringHash gives the characters, so symbols mix with
+  // string_view lookups in BasicStringHash tables.
+  size_t hash() const noexcept;
+
+  bool operator==(const Symbol &other) const noexcept = default;
+
+private:
+  template <typename, typename> friend class BasicInternPool;
+
+  using entry_type = string_intern::Entry<CharT>;
+
+  explicit Symbol(const entry_type *entry) noexcept : entry_(entry) {}
+
+  static constexpr CharT empty_[1] = {};
+
+  const entry_type *entry_ = nullptr;
+};
+
+// Sharded intern pool mapping strings to stable Symbols. Each shard is an
+// open-addressing table of entry pointers; lookups probe it without
+// locking, and only inserting a new string takes the shard's mutex. A table
+// that fills up is replaced by a larger copy, and old tables are kept until
+// the pool is destroyed so readers still probing them stay safe. The
+// characters are bump-allocated from per-shard ArenaResource blocks rather
+// than one allocation per string.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class BasicInternPool {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using symbol_type = Symbol<CharT, Traits>;
+
+  static constexpr size_t shard_count = 64;
+  static constexpr size_t default_block_size = 64 * 1024;
+
+  explicit BasicInternPool(size_t block_size = default_block_size);
+  BasicInternPool(const BasicInternPool &) = delete;
+  BasicInternPool &operator=(const BasicInternPool &) = delete;
+  ~BasicInternPool();
+
+  // Returns the symbol for str, adding it to the pool on first sight. Safe
+  // to call from any number of threads.
+  symbol_type intern(view_type str);
+  // Returns the symbol for str if it has been interned, the empty symbol
+  // otherwise.
+  symbol_type find(view_type str) const noexcept;
+
+  // Number of distinct non-empty strings interned.
+  size_t size() const noexcept;
+
+private:
+  using entry_type = string_intern::Entry<CharT>;
+
+  struct Table {
+    explicit Table(size_t capacity)
+        : mask(capacity - 1),
+          slots(new std::atomic<const entry_type *>[capacity]) {
+      for (size_t i = 0; i < capacity; ++i)
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<const entry_type *>[]> slots;
+  };
+
+  // Shards sit on their own cache lines so that interning into one does not
+  // slow down readers of its neighbours.
+  struct alignas(64) Shard {
+    std::atomic<Table *> table{nullptr};
+    std::atomic<size_t> count{0};
+    std::mutex mutex;
+    std::optional<ArenaResource> arena;
+    std::vector<std::unique_ptr<Table>> tables;
+  };
+
+  static constexpr size_t initial_capacity = 64;
+
+  static size_t hash_of(view_type str) noexcept;
+  static Shard &shard_for(const std::unique_ptr<Shard[]> &shards,
+                          size_t hash) noexcept;
+  static size_t slot_for(size_t hash) noexcept;
+  static const entry_type *probe(const Table &table, view_type str,
+                                 size_t hash) noexcept;
+  static void place(Table &table, const entry_type *entry) noexcept;
+  const entry_type *insert(Shard &shard, view_type str, size_t hash);
+
+  std::unique_ptr<Shard[]> shards_;
+};
+
+using InternPool = BasicInternPool<char>;
+
+template <typename CharT, typename Traits>
+inline const CharT *Symbol<CharT, Traits>::data() const noexcept {
+  return entry_ != nullptr ? entry_->chars() : empty_;
+}
+
+template <typename CharT, typename Traits>
+inline const CharT *Symbol<CharT, Traits>::c_str() const noexcept {
+  return data();
+}
+
+template <typename CharT, typename Traits>
+inline size_t Symbol<CharT, Traits>::size() const noexcept {
+  return entry_ != nullptr ? entry_->size : 0;
+}
+
+template <typename CharT, typename Traits>
+inline bool Symbol<CharT, Traits>::empty() const noexcept {
+  return entry_ == nullptr;
+}
+
+template <typename CharT, typename Traits>
+inline typename Symbol<CharT, Traits>::view_type
+Symbol<CharT, Traits>::view() const noexcept {
+  return view_type(data(), size());
+}
+
+template <typename CharT, typename Traits>
+inline Symbol<CharT, Traits>::operator view_type() const noexcept {
+  return view();
+}
+
+template <typename CharT, typename Traits>
+inline size_t Symbol<CharT, Traits>::hash() const noexcept {
+  return entry_ != nullptr ? entry_->hash
+                           : BasicStringHash<CharT, Traits>()(view_type());
+}
+
+template <typename CharT, typename Traits>
+inline BasicInternPool<CharT, Traits>::BasicInternPool(size_t block_size)
+    : shards_(std::make_unique<Shard[]>(shard_count)) {
+  for (size_t i = 0; i < shard_count; ++i)
+    shards_[i].arena.emplace(block_size);
+}
+
+template <typename CharT, typename Traits>
+inline BasicInternPool<CharT, Traits>::~BasicInternPool() = default;
+
+template <typename CharT, typename Traits>
+inline size_t BasicInternPool<CharT, Traits>::hash_of(view_type str) noexcept {
+  return BasicStringHash<CharT, Traits>()(str);
+}
+
+// The low bits of the hash pick the shard and the rest pick the slot, so
+// the two choices stay independent.
+template <typename CharT, typename Traits>
+inline typename BasicInternPool<CharT, Traits>::Shard &
+BasicInternPool<CharT, Traits>::shard_for(
+    const std::unique_ptr<Shard[]> &shards, size_t hash) noexcept {
+  return shards[hash % shard_count];
+}
+
+template <typename CharT, typename Traits>
+inline size_t BasicInternPool<CharT, Traits>::slot_for(size_t hash) noexcept {
+  return hash / shard_count;
+}
+
+template <typename CharT, typename Traits>
+inline const typename BasicInternPool<CharT, Traits>::entry_type *
+BasicInternPool<CharT, Traits>::probe(const Table &table, view_type str,
+                                      size_t hash) noexcept {
+  for (size_t i = slot_for(hash) & table.mask;; i = (i + 1) & table.mask) {
+    const entry_type *entry = table.slots[i].load(std::memory_order_acquire);
+    if (entry == nullptr)
+      return nullptr;
+    if (entry->hash == hash &&
+        view_type(entry->chars(), entry->size) == str)
+      return entry;
+  }
+}
+
+template <typename CharT, typename Traits>
+inline void BasicInternPool<CharT, Traits>::place(
+    Table &table, const entry_type *entry) noexcept {
+  size_t i = slot_for(entry->hash) & table.mask;
+  while (table.slots[i].load(std::memory_order_relaxed) != nullptr)
+    i = (i + 1) & table.mask;
+  table.slots[i].store(entry, std::memory_order_release);
+}
+
+template <typename CharT, typename Traits>
+inline typename BasicInternPool<CharT, Traits>::symbol_type
+BasicInternPool<CharT, Traits>::find(view_type str) const noexcept {
+  if (str.empty())
+    return symbol_type();
+
+  size_t hash = hash_of(str);
+  const Table *table =
+      shard_for(shards_, hash).table.load(std::memory_order_acquire);
+  return symbol_type(table != nullptr ? probe(*table, str, hash) : nullptr);
+}
+
+template <typename CharT, typename Traits>
+inline typename BasicInternPool<CharT, Traits>::symbol_type
+BasicInternPool<CharT, Traits>::intern(view_type str) {
+  if (str.empty())
+    return symbol_type();
+
+  size_t hash = hash_of(str);
+  Shard &shard = shard_for(shards_, hash);
+  const Table *table = shard.table.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    if (const entry_type *entry = probe(*table, str, hash))
+      return symbol_type(entry);
+  }
+  return symbol_type(insert(shard, str, hash));
+}
+
+// Slow path: another thread may have added str or grown the table since
+// the lock-free probe, so look again under the lock.
+template <typename CharT, typename Traits>
+inline const typename BasicInternPool<CharT, Traits>::entry_type *
+BasicInternPool<CharT, Traits>::insert(Shard &shard, view_type str,
+                                       size_t hash) {
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  Table *table = shard.table.load(std::memory_order_relaxed);
+  if (table != nullptr) {
+    if (const entry_type *entry = probe(*table, str, hash))
+      return entry;
+  }
+
+  // Keep the table at most half full so probe sequences stay short. The
+  // replacement is filled before it is published; the old one stays
+  // readable for probes that are still running.
+  size_t count = shard.count.load(std::memory_order_relaxed);
+  if (table == nullptr || (count + 1) * 2 > table->mask + 1) {
+    size_t capacity = table != nullptr ? (table->mask + 1) * 2
+                                       : initial_capacity;
+    auto grown = std::make_unique<Table>(capacity);
+    if (table != nullptr) {
+      for (size_t i = 0; i <= table->mask; ++i) {
+        if (const entry_type *entry =
+                table->slots[i].load(std::memory_order_relaxed))
+          place(*grown, entry);
+      }
+    }
+    table = grown.get();
+    shard.tables.push_back(std::move(grown));
+    shard.table.store(table, std::memory_order_release);
+  }
+
+  void *memory = shard.arena->allocate(
+      sizeof(entry_type) + (str.size() + 1) * sizeof(CharT),
+      alignof(entry_type));
+  entry_type *entry = ::new (memory) entry_type{hash, str.size()};
+  CharT *chars = const_cast<CharT *>(entry->chars());
+  Traits::copy(chars, str.data(), str.size());
+  Traits::assign(chars[str.size()], CharT());
+
+  place(*table, entry);
+  shard.count.store(count + 1, std::memory_order_relaxed);
+  return entry;
+}
+
+template <typename CharT, typename Traits>
+inline size_t BasicInternPool<CharT, Traits>::size() const noexcept {
+  size_t total = 0;
+  for (size_t i = 0; i < shard_count; ++i)
+    total += shards_[i].count.load(std::memory_order_relaxed);
+  return total;
+}
+
+template <typename CharT, typename Traits>
+struct std::hash<Symbol<CharT, Traits>> {
+  size_t operator()(const Symbol<CharT, Traits> &symbol) const noexcept {
+    return symbol.hash();
+  }
+};
+
+#endif
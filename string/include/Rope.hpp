@@ -0,0 +1,596 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BasicString.hpp"
+
+// Rope for large, frequently edited text. The characters live in BasicString
+// leaves of at most max_leaf characters, joined by concatenation nodes into
+// a height-balanced (AVL) tree. Nodes are immutable and shared, so copying
+// a rope or concatenating two ropes never copies characters, and insert,
+// erase, replace and substr cost O(log n) plus at most two leaf copies,
+// instead of moving the whole tail as BasicString does.
+//
+// Edits that stay inside one leaf rewrite that leaf in place of the old
+// one, so repeated small edits do not fragment the tree. flatten() builds
+// a BasicString with a single allocation; chunks() walks the leaves in
+// order as contiguous string_views for kernels that work on spans.
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+class Rope {
+public:
+  using string_type = BasicString<CharT, Traits, Allocator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using value_type = CharT;
+  using traits_type = Traits;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+  static constexpr size_type max_leaf = 4096 / sizeof(CharT);
+
+private:
+  struct Node;
+  using node_ptr = std::shared_ptr<const Node>;
+
+  // A leaf has no children and keeps its characters in `leaf`; an inner
+  // node has both children and an empty `leaf`.
+  struct Node {
+    size_type size;
+    int height;
+    node_ptr left;
+    node_ptr right;
+    string_type leaf;
+  };
+
+public:
+  class chunk_iterator;
+
+  struct chunk_range {
+    chunk_iterator first;
+    chunk_iterator last;
+
+    chunk_iterator begin() const { return first; }
+    chunk_iterator end() const { return last; }
+  };
+
+  Rope();
+  explicit Rope(const Allocator &alloc);
+  explicit Rope(view_type sv, const Allocator &alloc = Allocator());
+  Rope(const CharT *str, const Allocator &alloc = Allocator());
+  explicit Rope(const string_type &str);
+  Rope(std::nullptr_t) = delete;
+
+  Allocator get_allocator() const;
+
+  size_type size() const noexcept;
+  bool empty() const noexcept;
+  // Looks the character up from the root, O(log n).
+  CharT operator[](size_type pos) const;
+  CharT at(size_type pos) const;
+
+  Rope &insert(size_type pos, view_type sv);
+  Rope &erase(size_type pos, size_type len = npos);
+  Rope &replace(size_type pos, size_type len, view_type sv);
+  Rope &append(view_type sv);
+  Rope &append(const Rope &other);
+  Rope &operator+=(view_type sv);
+  Rope &operator+=(const Rope &other);
+  void clear() noexcept;
+
+  Rope substr(size_type pos, size_type len = npos) const;
+  string_type flatten() const;
+  chunk_range chunks() const;
+  template <typename F> void for_each_chunk(F &&f) const;
+
+  bool operator==(view_type other) const;
+
+private:
+  Rope(node_ptr root, const Allocator &alloc);
+
+  static int height(const node_ptr &node) noexcept;
+  static size_type size_of(const node_ptr &node) noexcept;
+  static bool is_leaf(const node_ptr &node) noexcept;
+
+  node_ptr make_leaf(view_type sv) const;
+  node_ptr make_node(node_ptr left, node_ptr right) const;
+  node_ptr build(view_type sv) const;
+  node_ptr build(view_type sv, size_type chunk, size_type first,
+                 size_type last) const;
+  node_ptr rotate_left(const node_ptr &node) const;
+  node_ptr rotate_right(const node_ptr &node) const;
+  node_ptr join_right(const node_ptr &left, const node_ptr &right) const;
+  node_ptr join_left(const node_ptr &left, const node_ptr &right) const;
+  node_ptr join(const node_ptr &left, const node_ptr &right) const;
+  node_ptr concat(const node_ptr &left, const node_ptr &right) const;
+  std::pair<node_ptr, node_ptr> split(const node_ptr &node,
+                                      size_type pos) const;
+  template <typename Edit>
+  node_ptr edit_leaf(const node_ptr &node, size_type pos, size_type len,
+                     size_type grow, Edit &edit) const;
+
+  node_ptr root_;
+  [[no_unique_address]] allocator_type allocator_;
+};
+
+// Walks the leaves left to right. The stack holds the current leaf on top
+// of the right subtrees still to visit.
+template <typename CharT, typename Traits, typename Allocator>
+class Rope<CharT, Traits, Allocator>::chunk_iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = view_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const view_type *;
+  using reference = view_type;
+
+  chunk_iterator() = default;
+
+  view_type operator*() const { return view_type(stack_.back()->leaf); }
+
+  chunk_iterator &operator++() {
+    stack_.pop_back();
+    if (!stack_.empty()) {
+      const Node *next = stack_.back();
+      stack_.pop_back();
+      descend(next);
+    }
+    return *this;
+  }
+
+  chunk_iterator operator++(int) {
+    chunk_iterator copy = *this;
+    ++*this;
+    return copy;
+  }
+
+  bool operator==(const chunk_iterator &other) const {
+    return stack_.empty() ? other.stack_.empty()
+                          : !other.stack_.empty() &&
+                                stack_.back() == other.stack_.back();
+  }
+
+private:
+  friend class Rope;
+
+  explicit chunk_iterator(const Node *root) {
+    if (root != nullptr)
+      descend(root);
+  }
+
+  // Pushes the path to the leftmost leaf under node; right children wait on
+  // the stack until their left sibling is done.
+  void descend(const Node *node) {
+    while (node->left != nullptr) {
+      stack_.push_back(node->right.get());
+      node = node->left.get();
+    }
+    stack_.push_back(node);
+  }
+
+  std::vector<const Node *> stack_;
+};
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>::Rope() : root_() {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>::Rope(const Allocator &alloc)
+    : root_(), allocator_(alloc) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>::Rope(view_type sv,
+                                            const Allocator &alloc)
+    : root_(), allocator_(alloc) {
+  root_ = build(sv);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>::Rope(const CharT *str,
+                                            const Allocator &alloc)
+    : Rope(view_type(str), alloc) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>::Rope(const string_type &str)
+    : Rope(view_type(str), str.get_allocator()) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>::Rope(node_ptr root,
+                                            const Allocator &alloc)
+    : root_(std::move(root)), allocator_(alloc) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Allocator Rope<CharT, Traits, Allocator>::get_allocator() const {
+  return allocator_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline int
+Rope<CharT, Traits, Allocator>::height(const node_ptr &node) noexcept {
+  return node != nullptr ? node->height : -1;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::size_type
+Rope<CharT, Traits, Allocator>::size_of(const node_ptr &node) noexcept {
+  return node != nullptr ? node->size : 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool
+Rope<CharT, Traits, Allocator>::is_leaf(const node_ptr &node) noexcept {
+  return node != nullptr && node->left == nullptr;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::make_leaf(view_type sv) const {
+  if (sv.empty())
+    return nullptr;
+  return std::allocate_shared<Node>(
+      allocator_, Node{sv.size(), 0, nullptr, nullptr,
+                       string_type(sv, allocator_)});
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::make_node(node_ptr left,
+                                          node_ptr right) const {
+  size_type size = left->size + right->size;
+  int h = std::max(left->height, right->height) + 1;
+  return std::allocate_shared<Node>(
+      allocator_,
+      Node{size, h, std::move(left), std::move(right), string_type(allocator_)});
+}
+
+// Cuts sv into leaves of (nearly) equal length and builds a perfectly
+// balanced tree over them.
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::build(view_type sv) const {
+  if (sv.size() <= max_leaf)
+    return make_leaf(sv);
+
+  size_type leaves = (sv.size() + max_leaf - 1) / max_leaf;
+  size_type chunk = (sv.size() + leaves - 1) / leaves;
+  return build(sv, chunk, 0, leaves);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::build(view_type sv, size_type chunk,
+                                      size_type first, size_type last) const {
+  if (last - first == 1)
+    return make_leaf(sv.substr(first * chunk, chunk));
+
+  size_type mid = first + (last - first) / 2;
+  return make_node(build(sv, chunk, first, mid), build(sv, chunk, mid, last));
+}
+
+// (x, (y, z)) -> ((x, y), z)
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::rotate_left(const node_ptr &node) const {
+  const node_ptr &right = node->right;
+  return make_node(make_node(node->left, right->left), right->right);
+}
+
+// ((x, y), z) -> (x, (y, z))
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::rotate_right(const node_ptr &node) const {
+  const node_ptr &left = node->left;
+  return make_node(left->left, make_node(left->right, node->right));
+}
+
+// AVL join for height(left) > height(right) + 1: walk down the right spine
+// of left until the heights meet, attach right there and rebalance on the
+// way back up. Costs O(height difference).
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::join_right(const node_ptr &left,
+                                           const node_ptr &right) const {
+  const node_ptr &l = left->left;
+  const node_ptr &c = left->right;
+  if (height(c) <= height(right) + 1) {
+    node_ptr joined = make_node(c, right);
+    if (height(joined) <= height(l) + 1)
+      return make_node(l, std::move(joined));
+    return rotate_left(make_node(l, rotate_right(joined)));
+  }
+
+  node_ptr joined = join_right(c, right);
+  node_ptr result = make_node(l, joined);
+  if (height(joined) <= height(l) + 1)
+    return result;
+  return rotate_left(result);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::join_left(const node_ptr &left,
+                                          const node_ptr &right) const {
+  const node_ptr &c = right->left;
+  const node_ptr &r = right->right;
+  if (height(c) <= height(left) + 1) {
+    node_ptr joined = make_node(left, c);
+    if (height(joined) <= height(r) + 1)
+      return make_node(std::move(joined), r);
+    return rotate_right(make_node(rotate_left(joined), r));
+  }
+
+  node_ptr joined = join_left(left, c);
+  node_ptr result = make_node(joined, r);
+  if (height(joined) <= height(r) + 1)
+    return result;
+  return rotate_right(result);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::join(const node_ptr &left,
+                                     const node_ptr &right) const {
+  if (left == nullptr)
+    return right;
+  if (right == nullptr)
+    return left;
+  if (height(left) > height(right) + 1)
+    return join_right(left, right);
+  if (height(right) > height(left) + 1)
+    return join_left(left, right);
+  return make_node(left, right);
+}
+
+// join() that also folds two small leaves into one, so splitting and
+// rejoining around short edits does not leave a trail of tiny leaves.
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::concat(const node_ptr &left,
+                                       const node_ptr &right) const {
+  if (is_leaf(left) && is_leaf(right) &&
+      left->size + right->size <= max_leaf) {
+    string_type leaf(allocator_);
+    leaf.reserve(left->size + right->size);
+    leaf.append(left->leaf).append(right->leaf);
+    size_type size = leaf.size();
+    return std::allocate_shared<Node>(
+        allocator_, Node{size, 0, nullptr, nullptr, std::move(leaf)});
+  }
+  return join(left, right);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline std::pair<typename Rope<CharT, Traits, Allocator>::node_ptr,
+                 typename Rope<CharT, Traits, Allocator>::node_ptr>
+Rope<CharT, Traits, Allocator>::split(const node_ptr &node,
+                                      size_type pos) const {
+  if (node == nullptr)
+    return {nullptr, nullptr};
+  if (pos == 0)
+    return {nullptr, node};
+  if (pos >= node->size)
+    return {node, nullptr};
+
+  if (is_leaf(node)) {
+    view_type text(node->leaf);
+    return {make_leaf(text.substr(0, pos)), make_leaf(text.substr(pos))};
+  }
+
+  size_type left_size = node->left->size;
+  if (pos < left_size) {
+    auto [first, second] = split(node->left, pos);
+    return {std::move(first), join(second, node->right)};
+  }
+  auto [first, second] = split(node->right, pos - left_size);
+  return {join(node->left, first), std::move(second)};
+}
+
+// Replaces the leaf holding [pos, pos + len) with edit(leaf, pos, len) and
+// copies the path above it. Returns nullptr, leaving the tree alone, when the range
+// spans leaves or the leaf would outgrow max_leaf by `grow` characters.
+template <typename CharT, typename Traits, typename Allocator>
+template <typename Edit>
+inline typename Rope<CharT, Traits, Allocator>::node_ptr
+Rope<CharT, Traits, Allocator>::edit_leaf(const node_ptr &node, size_type pos,
+                                          size_type len, size_type grow,
+                                          Edit &edit) const {
+  if (is_leaf(node)) {
+    if (node->size + grow > max_leaf)
+      return nullptr;
+    string_type leaf = edit(view_type(node->leaf), pos, len);
+    if (leaf.empty())
+      return nullptr;
+    size_type size = leaf.size();
+    return std::allocate_shared<Node>(
+        allocator_, Node{size, 0, nullptr, nullptr, std::move(leaf)});
+  }
+
+  size_type left_size = node->left->size;
+  if (pos + len <= left_size && (len > 0 || pos < left_size)) {
+    node_ptr left = edit_leaf(node->left, pos, len, grow, edit);
+    return left != nullptr ? make_node(std::move(left), node->right) : nullptr;
+  }
+  if (pos >= left_size) {
+    node_ptr right = edit_leaf(node->right, pos - left_size, len, grow, edit);
+    return right != nullptr ? make_node(node->left, std::move(right))
+                            : nullptr;
+  }
+  return nullptr;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::size_type
+Rope<CharT, Traits, Allocator>::size() const noexcept {
+  return size_of(root_);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool Rope<CharT, Traits, Allocator>::empty() const noexcept {
+  return root_ == nullptr;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline CharT Rope<CharT, Traits, Allocator>::operator[](size_type pos) const {
+  const Node *node = root_.get();
+  while (node->left != nullptr) {
+    if (pos < node->left->size) {
+      node = node->left.get();
+    } else {
+      pos -= node->left->size;
+      node = node->right.get();
+    }
+  }
+  return node->leaf[pos];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline CharT Rope<CharT, Traits, Allocator>::at(size_type pos) const {
+  if (pos >= size()) {
+    throw std::out_of_range("Rope::at: position out of range");
+  }
+  return (*this)[pos];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::insert(size_type pos, view_type sv) {
+  return replace(pos, 0, sv);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::erase(size_type pos, size_type len) {
+  return replace(pos, len, view_type());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::replace(size_type pos, size_type len,
+                                        view_type sv) {
+  if (pos > size()) {
+    throw std::out_of_range("Position is out of range.");
+  }
+
+  len = std::min(len, size() - pos);
+  if (len == 0 && sv.empty())
+    return *this;
+
+  if (root_ != nullptr && sv.size() <= max_leaf) {
+    // The old leaf stays alive until root_ is reassigned, so sv may point
+    // into it.
+    auto edit = [&](view_type leaf, size_type at, size_type count) {
+      string_type edited(allocator_);
+      edited.reserve(leaf.size() - count + sv.size());
+      edited.append(leaf.substr(0, at))
+          .append(sv)
+          .append(leaf.substr(at + count));
+      return edited;
+    };
+    size_type grow = sv.size() > len ? sv.size() - len : 0;
+    if (node_ptr edited = edit_leaf(root_, pos, len, grow, edit)) {
+      root_ = std::move(edited);
+      return *this;
+    }
+  }
+
+  auto [head, rest] = split(root_, pos);
+  auto [removed, tail] = split(rest, len);
+  root_ = concat(concat(head, build(sv)), tail);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::append(view_type sv) {
+  return replace(size(), 0, sv);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::append(const Rope &other) {
+  root_ = concat(root_, other.root_);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::operator+=(view_type sv) {
+  return append(sv);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator> &
+Rope<CharT, Traits, Allocator>::operator+=(const Rope &other) {
+  return append(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void Rope<CharT, Traits, Allocator>::clear() noexcept {
+  root_.reset();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>
+Rope<CharT, Traits, Allocator>::substr(size_type pos, size_type len) const {
+  if (pos > size()) {
+    throw std::out_of_range("Position is out of range.");
+  }
+
+  auto [head, rest] = split(root_, pos);
+  return Rope(split(rest, std::min(len, size() - pos)).first, allocator_);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::string_type
+Rope<CharT, Traits, Allocator>::flatten() const {
+  string_type result(allocator_);
+  result.reserve(size());
+  for_each_chunk([&result](view_type chunk) { result.append(chunk); });
+  return result;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename Rope<CharT, Traits, Allocator>::chunk_range
+Rope<CharT, Traits, Allocator>::chunks() const {
+  return chunk_range{chunk_iterator(root_.get()), chunk_iterator()};
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <typename F>
+inline void Rope<CharT, Traits, Allocator>::for_each_chunk(F &&f) const {
+  for (view_type chunk : chunks())
+    f(chunk);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool Rope<CharT, Traits, Allocator>::operator==(view_type other) const {
+  if (other.size() != size())
+    return false;
+
+  size_type offset = 0;
+  for (view_type chunk : chunks()) {
+    if (chunk != other.substr(offset, chunk.size()))
+      return false;
+    offset += chunk.size();
+  }
+  return true;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Rope<CharT, Traits, Allocator>
+operator+(const Rope<CharT, Traits, Allocator> &lhs,
+          const Rope<CharT, Traits, Allocator> &rhs) {
+  Rope<CharT, Traits, Allocator> result = lhs;
+  result.append(rhs);
+  return result;
+}
+
+#endif
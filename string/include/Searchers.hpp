@@ -0,0 +1,299 @@
+#ifndef SEARCHERS_H
+#define SEARCHERS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "BasicString.hpp"
+
+// Searchers that precompute their tables once and can then be run over any
+// number of BasicString or string_view haystacks. The tables are keyed on
+// the raw character values, so Traits::eq is expected to be plain equality.
+
+// Maps a character to one of 256 buckets of the shift table. Wide
+// characters share buckets, which only ever makes a shift smaller.
+template <typename CharT> inline constexpr size_t searcher_bucket(CharT ch) {
+  return static_cast<size_t>(static_cast<std::make_unsigned_t<CharT>>(ch)) &
+         0xFF;
+}
+
+// Boyer-Moore-Horspool search for one needle. Works best for long needles,
+// where most positions are skipped without being looked at.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class HorspoolSearcher {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  explicit HorspoolSearcher(view_type needle);
+
+  size_t find(view_type haystack, size_t pos = 0) const;
+  view_type needle() const;
+
+private:
+  BasicString<CharT, Traits> needle_;
+  std::array<size_t, 256> shift_;
+};
+
+template <typename CharT, typename Traits>
+inline HorspoolSearcher<CharT, Traits>::HorspoolSearcher(view_type needle)
+    : needle_(needle.data(), needle.size()) {
+  size_t m = needle.size();
+  shift_.fill(m == 0 ? 1 : m);
+  for (size_t i = 0; i + 1 < m; ++i) {
+    shift_[searcher_bucket(needle[i])] = m - 1 - i;
+  }
+}
+
+template <typename CharT, typename Traits>
+inline size_t HorspoolSearcher<CharT, Traits>::find(view_type haystack,
+                                                    size_t pos) const {
+  size_t n = haystack.size();
+  size_t m = needle_.size();
+  if (m == 0)
+    return pos <= n ? pos : npos;
+
+  const CharT *hay = haystack.data();
+  const CharT *needle = needle_.data();
+  const CharT last = needle[m - 1];
+
+  for (size_t i = pos; m <= n && i <= n - m;) {
+    CharT ch = hay[i + m - 1];
+    if (Traits::eq(ch, last) && Traits::compare(hay + i, needle, m - 1) == 0)
+      return i;
+    i += shift_[searcher_bucket(ch)];
+  }
+  return npos;
+}
+
+template <typename CharT, typename Traits>
+inline typename HorspoolSearcher<CharT, Traits>::view_type
+HorspoolSearcher<CharT, Traits>::needle() const {
+  return needle_;
+}
+
+// Aho-Corasick automaton over a fixed set of patterns. One pass over the
+// text reports every occurrence of every pattern, overlapping ones
+// included. Characters that occur in the patterns are mapped to dense
+// classes, so the transition table is states x (classes + 1) entries.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class AhoCorasickSearcher {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  struct Match {
+    size_t position;
+    size_t pattern;
+
+    bool operator==(const Match &) const = default;
+  };
+
+  AhoCorasickSearcher(std::initializer_list<view_type> patterns);
+  template <typename Range>
+  explicit AhoCorasickSearcher(const Range &patterns);
+
+  // Calls on_match(Match) for every occurrence, ordered by end position.
+  template <typename Callback>
+  void for_each_match(view_type text, Callback on_match) const;
+  std::vector<Match> find_all(view_type text) const;
+
+  size_t pattern_count() const;
+  size_t state_count() const;
+
+private:
+  static constexpr uint32_t none = static_cast<uint32_t>(-1);
+
+  void add_classes(view_type pattern);
+  void build(const std::vector<view_type> &patterns);
+  uint32_t char_class(CharT ch) const;
+  uint32_t &edge(uint32_t state, uint32_t cls);
+
+  std::vector<size_t> lengths_;
+  std::vector<std::pair<CharT, uint32_t>> wide_classes_;
+  std::array<uint32_t, 256> byte_classes_{};
+  uint32_t classes_ = 1;
+
+  std::vector<uint32_t> transitions_;
+  std::vector<uint32_t> terminal_;
+  std::vector<uint32_t> same_next_;
+  std::vector<uint32_t> dict_link_;
+};
+
+template <typename CharT, typename Traits>
+inline AhoCorasickSearcher<CharT, Traits>::AhoCorasickSearcher(
+    std::initializer_list<view_type> patterns)
+    : AhoCorasickSearcher(std::vector<view_type>(patterns)) {}
+
+template <typename CharT, typename Traits>
+template <typename Range>
+inline AhoCorasickSearcher<CharT, Traits>::AhoCorasickSearcher(
+    const Range &patterns) {
+  std::vector<view_type> views;
+  for (const auto &pattern : patterns)
+    views.push_back(view_type(pattern));
+
+  for (view_type pattern : views)
+    add_classes(pattern);
+  build(views);
+}
+
+template <typename CharT, typename Traits>
+inline void
+AhoCorasickSearcher<CharT, Traits>::add_classes(view_type pattern) {
+  for (CharT ch : pattern) {
+    if constexpr (sizeof(CharT) == 1) {
+      uint32_t &cls = byte_classes_[searcher_bucket(ch)];
+      if (cls == 0)
+        cls = classes_++;
+    } else {
+      auto it = std::lower_bound(
+          wide_classes_.begin(), wide_classes_.end(), ch,
+          [](const auto &entry, CharT c) { return entry.first < c; });
+      if (it == wide_classes_.end() || it->first != ch)
+        wide_classes_.insert(it, {ch, classes_++});
+    }
+  }
+}
+
+template <typename CharT, typename Traits>
+inline uint32_t
+AhoCorasickSearcher<CharT, Traits>::char_class(CharT ch) const {
+  if constexpr (sizeof(CharT) == 1) {
+    return byte_classes_[searcher_bucket(ch)];
+  } else {
+    auto it = std::lower_bound(
+        wide_classes_.begin(), wide_classes_.end(), ch,
+        [](const auto &entry, CharT c) { return entry.first < c; });
+    return it != wide_classes_.end() && it->first == ch ? it->second : 0;
+  }
+}
+
+template <typename CharT, typename Traits>
+inline uint32_t &AhoCorasickSearcher<CharT, Traits>::edge(uint32_t state,
+                                                         uint32_t cls) {
+  return transitions_[static_cast<size_t>(state) * classes_ + cls];
+}
+
+template <typename CharT, typename Traits>
+inline void AhoCorasickSearcher<CharT, Traits>::build(
+    const std::vector<view_type> &patterns) {
+  // Trie first; missing edges stay `none` until the BFS below. Empty
+  // patterns never match.
+  transitions_.assign(classes_, none);
+  terminal_.assign(1, none);
+  same_next_.assign(patterns.size(), none);
+  lengths_.resize(patterns.size());
+
+  for (size_t id = 0; id < patterns.size(); ++id) {
+    lengths_[id] = patterns[id].size();
+    if (patterns[id].empty())
+      continue;
+
+    uint32_t state = 0;
+    for (CharT ch : patterns[id]) {
+      uint32_t cls = char_class(ch);
+      if (edge(state, cls) == none) {
+        uint32_t next = static_cast<uint32_t>(terminal_.size());
+        edge(state, cls) = next;
+        transitions_.resize(transitions_.size() + classes_, none);
+        terminal_.push_back(none);
+      }
+      state = edge(state, cls);
+    }
+    same_next_[id] = terminal_[state];
+    terminal_[state] = static_cast<uint32_t>(id);
+  }
+
+  // Breadth-first pass: fill every missing edge from the failure state and
+  // link each state to the nearest proper suffix that ends a pattern.
+  std::vector<uint32_t> fail(terminal_.size(), 0);
+  dict_link_.assign(terminal_.size(), none);
+  std::deque<uint32_t> queue;
+
+  for (uint32_t cls = 0; cls < classes_; ++cls) {
+    uint32_t next = edge(0, cls);
+    if (next == none) {
+      edge(0, cls) = 0;
+    } else {
+      queue.push_back(next);
+    }
+  }
+
+  while (!queue.empty()) {
+    uint32_t state = queue.front();
+    queue.pop_front();
+
+    uint32_t link = fail[state];
+    dict_link_[state] = terminal_[link] != none ? link : dict_link_[link];
+
+    for (uint32_t cls = 0; cls < classes_; ++cls) {
+      uint32_t next = edge(state, cls);
+      if (next == none) {
+        edge(state, cls) = edge(link, cls);
+      } else {
+        fail[next] = edge(link, cls);
+        queue.push_back(next);
+      }
+    }
+  }
+
+  // Flatten into rows of classes_ + 1 entries: the offset of the next row
+  // for every class, then the first state with output reachable from this
+  // one, so the scan needs no multiply and one load to test for matches.
+  size_t stride = classes_ + 1;
+  std::vector<uint32_t> rows(terminal_.size() * stride);
+  for (uint32_t state = 0; state < terminal_.size(); ++state) {
+    uint32_t *row = rows.data() + state * stride;
+    for (uint32_t cls = 0; cls < classes_; ++cls)
+      row[cls] = static_cast<uint32_t>(edge(state, cls) * stride);
+    row[classes_] = terminal_[state] != none ? state : dict_link_[state];
+  }
+  transitions_ = std::move(rows);
+}
+
+template <typename CharT, typename Traits>
+template <typename Callback>
+inline void
+AhoCorasickSearcher<CharT, Traits>::for_each_match(view_type text,
+                                                   Callback on_match) const {
+  const uint32_t *table = transitions_.data();
+  uint32_t row = 0;
+
+  for (size_t i = 0; i < text.size(); ++i) {
+    row = table[row + char_class(text[i])];
+
+    for (uint32_t s = table[row + classes_]; s != none; s = dict_link_[s]) {
+      for (uint32_t id = terminal_[s]; id != none; id = same_next_[id]) {
+        on_match(Match{i + 1 - lengths_[id], id});
+      }
+    }
+  }
+}
+
+template <typename CharT, typename Traits>
+inline std::vector<typename AhoCorasickSearcher<CharT, Traits>::Match>
+AhoCorasickSearcher<CharT, Traits>::find_all(view_type text) const {
+  std::vector<Match> matches;
+  for_each_match(text, [&](const Match &match) { matches.push_back(match); });
+  return matches;
+}
+
+template <typename CharT, typename Traits>
+inline size_t AhoCorasickSearcher<CharT, Traits>::pattern_count() const {
+  return lengths_.size();
+}
+
+template <typename CharT, typename Traits>
+inline size_t AhoCorasickSearcher<CharT, Traits>::state_count() const {
+  return terminal_.size();
+}
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef SHARED_STRING_H
+#define SHARED_STRING_H
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+
+#include "BasicString.hpp"
+
+// Immutable, reference-counted companion to BasicString. The characters live
+// in one allocation behind a small header holding an atomic reference count,
+// so copying a SharedString is a pointer copy and an increment, and the same
+// value can be handed to many threads. Writing goes through mutable_data()
+// or modify(), which copy the buffer first if anyone else still holds it.
+//
+// A SharedString object itself is not synchronized: threads share a value by
+// each holding their own copy.
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+class SharedString {
+public:
+  using string_type = BasicString<CharT, Traits, Allocator>;
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using value_type = CharT;
+  using traits_type = Traits;
+  using allocator_type = Allocator;
+  using size_type = typename string_type::size_type;
+
+  SharedString() noexcept;
+  explicit SharedString(const Allocator &alloc) noexcept;
+  SharedString(const CharT *str, const Allocator &alloc = Allocator());
+  explicit SharedString(view_type sv, const Allocator &alloc = Allocator());
+  explicit SharedString(const string_type &str);
+  SharedString(const SharedString &other) noexcept;
+  SharedString(SharedString &&other) noexcept;
+  SharedString(std::nullptr_t) = delete;
+  ~SharedString();
+
+  SharedString &operator=(const SharedString &other) noexcept;
+  SharedString &operator=(SharedString &&other) noexcept;
+
+  Allocator get_allocator() const;
+
+  const CharT *data() const noexcept;
+  const CharT *c_str() const noexcept;
+  size_type size() const noexcept;
+  bool empty() const noexcept;
+  const CharT &operator[](size_type index) const;
+  operator view_type() const noexcept;
+
+  // Copies the characters into a BasicString with the same allocator.
+  string_type str() const;
+  explicit operator string_type() const;
+
+  // Number of SharedString objects holding this buffer; 0 for the empty
+  // string, which has no buffer.
+  long use_count() const noexcept;
+  bool unique() const noexcept;
+
+  // Writable pointer to the characters, copying them into a buffer of our
+  // own first if the current one is shared. nullptr for the empty string,
+  // which has no buffer and nothing to write.
+  CharT *mutable_data();
+  // Runs edit(string_type &) on a copy of the value and keeps the result.
+  // Needed for edits that change the length. A buffer held only by this
+  // object is written back in place when the result still fits in it.
+  template <typename Edit> void modify(Edit &&edit);
+
+  void swap(SharedString &other) noexcept;
+
+  bool operator==(const SharedString &other) const noexcept;
+  bool operator==(const string_type &other) const noexcept;
+  bool operator==(view_type other) const noexcept;
+  bool operator==(const CharT *other) const;
+  typename string_type::ordering operator<=>(view_type other) const;
+
+private:
+  // The header is followed by size + 1 characters, the last one a NUL.
+  struct Header {
+    std::atomic<long> refs;
+    size_type size;
+  };
+
+  using header_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Header>;
+  using header_traits = std::allocator_traits<header_allocator>;
+
+  static constexpr CharT empty_[1] = {};
+
+  static size_type units_for(size_type len) noexcept;
+  static CharT *chars(Header *header) noexcept;
+  void init(const CharT *str, size_type len);
+  void release() noexcept;
+
+  Header *header_;
+  [[no_unique_address]] allocator_type allocator_;
+};
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename SharedString<CharT, Traits, Allocator>::size_type
+SharedString<CharT, Traits, Allocator>::units_for(size_type len) noexcept {
+  return (sizeof(Header) + (len + 1) * sizeof(CharT) + sizeof(Header) - 1) /
+         sizeof(Header);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline CharT *
+SharedString<CharT, Traits, Allocator>::chars(Header *header) noexcept {
+  return reinterpret_cast<CharT *>(header + 1);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void SharedString<CharT, Traits, Allocator>::init(const CharT *str,
+                                                         size_type len) {
+  if (len == 0)
+    return;
+
+  header_allocator alloc(allocator_);
+  Header *header = header_traits::allocate(alloc, units_for(len));
+  ::new (static_cast<void *>(header)) Header{{1}, len};
+  traits_type::copy(chars(header), str, len);
+  traits_type::assign(chars(header)[len], CharT());
+  header_ = header;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void SharedString<CharT, Traits, Allocator>::release() noexcept {
+  if (header_ == nullptr)
+    return;
+
+  // The last holder has to see every other holder's reads finish before the
+  // buffer goes away.
+  if (header_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    size_type units = units_for(header_->size);
+    header_->~Header();
+    header_allocator alloc(allocator_);
+    header_traits::deallocate(alloc, header_, units);
+  }
+  header_ = nullptr;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString() noexcept
+    : header_(nullptr) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString(
+    const Allocator &alloc) noexcept
+    : header_(nullptr), allocator_(alloc) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString(
+    const CharT *str, const Allocator &alloc)
+    : header_(nullptr), allocator_(alloc) {
+  init(str, traits_type::length(str));
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString(
+    view_type sv, const Allocator &alloc)
+    : header_(nullptr), allocator_(alloc) {
+  init(sv.data(), sv.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString(
+    const string_type &str)
+    : header_(nullptr), allocator_(str.get_allocator()) {
+  init(str.data(), str.size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString(
+    const SharedString &other) noexcept
+    : header_(other.header_), allocator_(other.allocator_) {
+  if (header_ != nullptr)
+    header_->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::SharedString(
+    SharedString &&other) noexcept
+    : header_(std::exchange(other.header_, nullptr)),
+      allocator_(other.allocator_) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::~SharedString() {
+  release();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator> &
+SharedString<CharT, Traits, Allocator>::operator=(
+    const SharedString &other) noexcept {
+  SharedString(other).swap(*this);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator> &
+SharedString<CharT, Traits, Allocator>::operator=(
+    SharedString &&other) noexcept {
+  SharedString(std::move(other)).swap(*this);
+  return *this;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Allocator SharedString<CharT, Traits, Allocator>::get_allocator() const {
+  return allocator_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const CharT *
+SharedString<CharT, Traits, Allocator>::data() const noexcept {
+  return header_ != nullptr ? chars(header_) : empty_;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const CharT *
+SharedString<CharT, Traits, Allocator>::c_str() const noexcept {
+  return data();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename SharedString<CharT, Traits, Allocator>::size_type
+SharedString<CharT, Traits, Allocator>::size() const noexcept {
+  return header_ != nullptr ? header_->size : 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool SharedString<CharT, Traits, Allocator>::empty() const noexcept {
+  return header_ == nullptr;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline const CharT &
+SharedString<CharT, Traits, Allocator>::operator[](size_type index) const {
+  return data()[index];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::operator view_type()
+    const noexcept {
+  return view_type(data(), size());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename SharedString<CharT, Traits, Allocator>::string_type
+SharedString<CharT, Traits, Allocator>::str() const {
+  return string_type(view_type(*this), allocator_);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline SharedString<CharT, Traits, Allocator>::operator string_type() const {
+  return str();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline long SharedString<CharT, Traits, Allocator>::use_count() const noexcept {
+  return header_ != nullptr ? header_->refs.load(std::memory_order_relaxed)
+                            : 0;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool SharedString<CharT, Traits, Allocator>::unique() const noexcept {
+  return header_ != nullptr &&
+         header_->refs.load(std::memory_order_acquire) == 1;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline CharT *SharedString<CharT, Traits, Allocator>::mutable_data() {
+  if (header_ == nullptr)
+    return nullptr;
+
+  if (!unique()) {
+    SharedString copy(view_type(*this), allocator_);
+    copy.swap(*this);
+  }
+  return chars(header_);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <typename Edit>
+inline void SharedString<CharT, Traits, Allocator>::modify(Edit &&edit) {
+  string_type value = str();
+  std::forward<Edit>(edit)(value);
+  if (unique() && !value.empty() &&
+      units_for(value.size()) == units_for(header_->size)) {
+    traits_type::copy(chars(header_), value.data(), value.size());
+    traits_type::assign(chars(header_)[value.size()], CharT());
+    header_->size = value.size();
+    return;
+  }
+  SharedString(view_type(value), allocator_).swap(*this);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void
+SharedString<CharT, Traits, Allocator>::swap(SharedString &other) noexcept {
+  std::swap(header_, other.header_);
+  if constexpr (!std::allocator_traits<Allocator>::is_always_equal::value) {
+    using std::swap;
+    swap(allocator_, other.allocator_);
+  }
+}
+
+// Two handles on the same buffer are equal without looking at the
+// characters.
+template <typename CharT, typename Traits, typename Allocator>
+inline bool SharedString<CharT, Traits, Allocator>::operator==(
+    const SharedString &other) const noexcept {
+  return header_ == other.header_ || view_type(*this) == view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool SharedString<CharT, Traits, Allocator>::operator==(
+    const string_type &other) const noexcept {
+  return view_type(*this) == view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool SharedString<CharT, Traits, Allocator>::operator==(
+    view_type other) const noexcept {
+  return view_type(*this) == other;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline bool
+SharedString<CharT, Traits, Allocator>::operator==(const CharT *other) const {
+  return view_type(*this) == view_type(other);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename SharedString<CharT, Traits, Allocator>::string_type::ordering
+SharedString<CharT, Traits, Allocator>::operator<=>(view_type other) const {
+  using ordering = typename string_type::ordering;
+  return static_cast<ordering>(view_type(*this).compare(other) <=> 0);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void swap(SharedString<CharT, Traits, Allocator> &lhs,
+                 SharedString<CharT, Traits, Allocator> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+struct std::hash<SharedString<CharT, Traits, Allocator>> {
+  size_t operator()(
+      const SharedString<CharT, Traits, Allocator> &str) const noexcept {
+    return BasicStringHash<CharT, Traits>()(str);
+  }
+};
+
+#endif
@@ -0,0 +1,390 @@
+#ifndef STRING_CASE_H
+#define STRING_CASE_H
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "BasicString.hpp"
+#include "StringHash.hpp"
+
+#if !defined(STRING_NO_SIMD) && defined(__GNUC__) &&                           \
+    (defined(__x86_64__) || defined(__i386__))
+#define STRING_CASE_X86 1
+#include <immintrin.h>
+#endif
+
+// ASCII case conversion and case-insensitive comparison. Only 'A'-'Z' and
+// 'a'-'z' change case; every other value, including the bytes of multi-byte
+// UTF-8 sequences, is left alone, which is what protocol header names and
+// identifiers need.
+//
+// For char the in-place and copying transforms run 32 bytes at a time with
+// AVX2 when the CPU has it (picked at runtime) and 16 at a time with SSE2
+// otherwise. CaseInsensitiveTraits plugs into BasicString's Traits
+// parameter, and BasicStringHash and BasicStringEqual for those traits hash
+// and compare the folded characters without building a lowered copy.
+namespace string_case {
+
+template <typename CharT> inline constexpr CharT fold(CharT ch) noexcept {
+  return ch >= CharT('A') && ch <= CharT('Z') ? CharT(ch - 'A' + 'a') : ch;
+}
+
+template <typename CharT> inline constexpr CharT unfold(CharT ch) noexcept {
+  return ch >= CharT('a') && ch <= CharT('z') ? CharT(ch - 'a' + 'A') : ch;
+}
+
+// Eight bytes at once: adding to the low seven bits of each byte sets its
+// top bit exactly when the byte is past a bound, and bytes that already had
+// the top bit set are not ASCII.
+template <bool Upper>
+inline constexpr uint64_t transform_word(uint64_t v) noexcept {
+  constexpr uint64_t ones = 0x0101010101010101ull;
+  constexpr uint64_t high = 0x8080808080808080ull;
+  constexpr uint64_t first = Upper ? 'a' : 'A';
+  constexpr uint64_t last = Upper ? 'z' : 'Z';
+  uint64_t low7 = v & ~high;
+  uint64_t past_first = low7 + (0x80 - first) * ones;
+  uint64_t past_last = low7 + (0x7F - last) * ones;
+  uint64_t in_range = (past_first ^ past_last) & ~v & high;
+  return v ^ (in_range >> 2);
+}
+
+template <bool Upper>
+inline void transform_scalar(const char *src, size_t n, char *dst) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, src + i, sizeof(word));
+    word = transform_word<Upper>(word);
+    std::memcpy(dst + i, &word, sizeof(word));
+  }
+  for (; i < n; ++i)
+    dst[i] = Upper ? unfold(src[i]) : fold(src[i]);
+}
+
+#ifdef STRING_CASE_X86
+
+// Signed compares: bytes from 0x80 up are negative and never in range.
+template <bool Upper> inline __m128i transform_block(__m128i v) {
+  const __m128i before = _mm_set1_epi8(Upper ? 'a' - 1 : 'A' - 1);
+  const __m128i after = _mm_set1_epi8(Upper ? 'z' + 1 : 'Z' + 1);
+  __m128i in_range =
+      _mm_and_si128(_mm_cmpgt_epi8(v, before), _mm_cmpgt_epi8(after, v));
+  return _mm_xor_si128(v, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+}
+
+template <bool Upper>
+inline void transform_sse2(const char *src, size_t n, char *dst) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     transform_block<Upper>(v));
+  }
+  transform_scalar<Upper>(src + i, n - i, dst + i);
+}
+
+template <bool Upper>
+__attribute__((target("avx2"))) inline void
+transform_avx2(const char *src, size_t n, char *dst) {
+  const __m256i before = _mm256_set1_epi8(Upper ? 'a' - 1 : 'A' - 1);
+  const __m256i after = _mm256_set1_epi8(Upper ? 'z' + 1 : 'Z' + 1);
+  const __m256i flip = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(v, before),
+                                        _mm256_cmpgt_epi8(after, v));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst + i),
+        _mm256_xor_si256(v, _mm256_and_si256(in_range, flip)));
+  }
+  transform_sse2<Upper>(src + i, n - i, dst + i);
+}
+
+#endif
+
+using transform_kernel = void (*)(const char *, size_t, char *);
+
+template <bool Upper> inline transform_kernel select_transform_kernel() {
+#ifdef STRING_CASE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return transform_avx2<Upper>;
+  return transform_sse2<Upper>;
+#else
+  return transform_scalar<Upper>;
+#endif
+}
+
+// Writes the lower- or upper-case form of src[0..n) to dst, which may be
+// src itself.
+inline void lower(const char *src, size_t n, char *dst) {
+  static const transform_kernel kernel = select_transform_kernel<false>();
+  kernel(src, n, dst);
+}
+
+inline void upper(const char *src, size_t n, char *dst) {
+  static const transform_kernel kernel = select_transform_kernel<true>();
+  kernel(src, n, dst);
+}
+
+template <bool Upper, typename CharT>
+inline constexpr void transform(const CharT *src, size_t n, CharT *dst) {
+  if constexpr (std::is_same_v<CharT, char>) {
+    if (!std::is_constant_evaluated()) {
+      Upper ? upper(src, n, dst) : lower(src, n, dst);
+      return;
+    }
+  }
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = Upper ? unfold(src[i]) : fold(src[i]);
+}
+
+// Three-way comparison of the folded characters, as unsigned values.
+template <typename CharT>
+inline constexpr int compare_folded(const CharT *lhs, const CharT *rhs,
+                                    size_t n) noexcept {
+  using unsigned_type = std::make_unsigned_t<CharT>;
+  size_t i = 0;
+#ifdef STRING_CASE_X86
+  if constexpr (std::is_same_v<CharT, char>) {
+    if (!std::is_constant_evaluated()) {
+      // Skip blocks that agree once folded; the first one that does not is
+      // finished by the scalar loop below.
+      for (; i + 16 <= n; i += 16) {
+        __m128i a = transform_block<false>(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i)));
+        __m128i b = transform_block<false>(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
+          break;
+      }
+    }
+  }
+#endif
+  if constexpr (std::is_same_v<CharT, char>) {
+    if (!std::is_constant_evaluated()) {
+      for (; i + 8 <= n; i += 8) {
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, lhs + i, sizeof(a));
+        std::memcpy(&b, rhs + i, sizeof(b));
+        if (transform_word<false>(a) != transform_word<false>(b))
+          break;
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    auto a = static_cast<unsigned_type>(fold(lhs[i]));
+    auto b = static_cast<unsigned_type>(fold(rhs[i]));
+    if (a != b)
+      return a < b ? -1 : 1;
+  }
+  return 0;
+}
+
+// Reads the characters the way string_hash::char_reader does, folded, so
+// that a case-insensitive hash equals the ordinary hash of the lower-case
+// string. Plain char strings on little-endian targets read whole words.
+template <typename CharT> struct folding_reader {
+  const CharT *p;
+
+  constexpr uint64_t byte(size_t i) const {
+    using unsigned_type = std::make_unsigned_t<CharT>;
+    auto ch = static_cast<unsigned_type>(fold(p[i / sizeof(CharT)]));
+    return (static_cast<uint64_t>(ch) >> (8 * (i % sizeof(CharT)))) & 0xFF;
+  }
+
+  template <typename Word> constexpr uint64_t read(size_t i) const {
+    if constexpr (sizeof(CharT) == 1 &&
+                  std::endian::native == std::endian::little) {
+      if (!std::is_constant_evaluated()) {
+        Word v;
+        std::memcpy(&v, p + i, sizeof(v));
+        return transform_word<false>(v);
+      }
+    }
+    uint64_t v = 0;
+    for (size_t k = 0; k < sizeof(Word); ++k)
+      v |= byte(i + k) << (8 * k);
+    return v;
+  }
+
+  constexpr uint64_t read64(size_t i) const { return read<uint64_t>(i); }
+  constexpr uint64_t read32(size_t i) const { return read<uint32_t>(i); }
+};
+
+} // namespace string_case
+
+// Character traits that compare ASCII letters without regard to case.
+// BasicString<char, CaseInsensitiveTraits<char>> keeps the characters as
+// given but compares, searches and hashes them folded.
+template <typename CharT>
+struct CaseInsensitiveTraits : std::char_traits<CharT> {
+  using char_type = CharT;
+  using comparison_category = std::weak_ordering;
+
+  static constexpr bool eq(char_type a, char_type b) noexcept {
+    return string_case::fold(a) == string_case::fold(b);
+  }
+
+  static constexpr bool lt(char_type a, char_type b) noexcept {
+    using unsigned_type = std::make_unsigned_t<char_type>;
+    return static_cast<unsigned_type>(string_case::fold(a)) <
+           static_cast<unsigned_type>(string_case::fold(b));
+  }
+
+  static constexpr int compare(const char_type *lhs, const char_type *rhs,
+                               size_t n) noexcept {
+    return string_case::compare_folded(lhs, rhs, n);
+  }
+
+  static constexpr const char_type *find(const char_type *str, size_t n,
+                                         const char_type &ch) noexcept {
+    char_type folded = string_case::fold(ch);
+    for (size_t i = 0; i < n; ++i) {
+      if (string_case::fold(str[i]) == folded)
+        return str + i;
+    }
+    return nullptr;
+  }
+};
+
+template <typename CharT, typename Allocator = std::allocator<CharT>>
+using CaseInsensitiveString =
+    BasicString<CharT, CaseInsensitiveTraits<CharT>, Allocator>;
+
+namespace string_case {
+
+// Characters of any string-like key, whichever of the two traits its view
+// uses.
+template <typename CharT, typename Key>
+inline constexpr std::basic_string_view<CharT> chars_of(const Key &key) {
+  using folded_view =
+      std::basic_string_view<CharT, CaseInsensitiveTraits<CharT>>;
+  if constexpr (std::is_convertible_v<const Key &, folded_view>) {
+    folded_view view = key;
+    return std::basic_string_view<CharT>(view.data(), view.size());
+  } else {
+    return std::basic_string_view<CharT>(key);
+  }
+}
+
+} // namespace string_case
+
+// Hashes the folded characters. Transparent over both traits, so a table
+// keyed by CaseInsensitiveString can be probed with a plain string_view.
+template <typename CharT>
+struct BasicStringHash<CharT, CaseInsensitiveTraits<CharT>> {
+  using is_transparent = void;
+
+  template <typename Key>
+  constexpr size_t operator()(const Key &key) const noexcept {
+    std::basic_string_view<CharT> chars = string_case::chars_of<CharT>(key);
+    return static_cast<size_t>(string_hash::hash_with(
+        string_case::folding_reader<CharT>{chars.data()},
+        chars.size() * sizeof(CharT), 0));
+  }
+};
+
+template <typename CharT>
+struct BasicStringEqual<CharT, CaseInsensitiveTraits<CharT>> {
+  using is_transparent = void;
+
+  template <typename Lhs, typename Rhs>
+  constexpr bool operator()(const Lhs &lhs, const Rhs &rhs) const noexcept {
+    std::basic_string_view<CharT> a = string_case::chars_of<CharT>(lhs);
+    std::basic_string_view<CharT> b = string_case::chars_of<CharT>(rhs);
+    return a.size() == b.size() &&
+           string_case::compare_folded(a.data(), b.data(), a.size()) == 0;
+  }
+};
+
+// In-place transforms.
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void to_lower(BasicString<CharT, Traits, Allocator> &str) {
+  str.resize_and_overwrite(str.size(), [](CharT *data, size_t n) {
+    string_case::transform<false>(data, n, data);
+    return n;
+  });
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void to_upper(BasicString<CharT, Traits, Allocator> &str) {
+  str.resize_and_overwrite(str.size(), [](CharT *data, size_t n) {
+    string_case::transform<true>(data, n, data);
+    return n;
+  });
+}
+
+// The form CaseInsensitiveTraits compares by; for ASCII that is lower case.
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr void
+ascii_casefold(BasicString<CharT, Traits, Allocator> &str) {
+  to_lower(str);
+}
+
+// Copying transforms, written straight into the new string.
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+inline constexpr BasicString<CharT, Traits, Allocator>
+to_lower_copy(std::basic_string_view<CharT, Traits> str,
+              const Allocator &alloc = Allocator()) {
+  BasicString<CharT, Traits, Allocator> out(alloc);
+  out.resize_and_overwrite(str.size(), [&](CharT *data, size_t n) {
+    string_case::transform<false>(str.data(), n, data);
+    return n;
+  });
+  return out;
+}
+
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+inline constexpr BasicString<CharT, Traits, Allocator>
+to_upper_copy(std::basic_string_view<CharT, Traits> str,
+              const Allocator &alloc = Allocator()) {
+  BasicString<CharT, Traits, Allocator> out(alloc);
+  out.resize_and_overwrite(str.size(), [&](CharT *data, size_t n) {
+    string_case::transform<true>(str.data(), n, data);
+    return n;
+  });
+  return out;
+}
+
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+inline constexpr BasicString<CharT, Traits, Allocator>
+ascii_casefold_copy(std::basic_string_view<CharT, Traits> str,
+                    const Allocator &alloc = Allocator()) {
+  return to_lower_copy(str, alloc);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>
+to_lower_copy(const BasicString<CharT, Traits, Allocator> &str) {
+  return to_lower_copy(std::basic_string_view<CharT, Traits>(str),
+                       str.get_allocator());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>
+to_upper_copy(const BasicString<CharT, Traits, Allocator> &str) {
+  return to_upper_copy(std::basic_string_view<CharT, Traits>(str),
+                       str.get_allocator());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline constexpr BasicString<CharT, Traits, Allocator>
+ascii_casefold_copy(const BasicString<CharT, Traits, Allocator> &str) {
+  return to_lower_copy(str);
+}
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef STRING_FORMAT_H
+#define STRING_FORMAT_H
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <version>
+
+#if defined(__cpp_lib_format)
+#include <format>
+#define STRING_FORMAT_STD 1
+#elif defined(STRING_FORMAT_FMT)
+#include <fmt/format.h>
+#endif
+
+#if defined(STRING_FORMAT_STD) || defined(STRING_FORMAT_FMT)
+#define STRING_FORMAT_ENABLED 1
+#endif
+
+#include "BasicString.hpp"
+
+// Number and format output straight into a BasicString. append_int and
+// append_float reserve room after the current end with reserve_append,
+// run std::to_chars there (shortest round-trip output for floating point
+// unless a precision is given) and commit what was written, so a log line
+// is built without a temporary string per field. Wide strings go through a
+// small stack buffer, since to_chars only writes char.
+//
+// Where the standard library has <format>, BasicString is also a format
+// argument, and append_format formats into the string's spare capacity.
+// std::back_inserter(str) works as a format_to output iterator as well.
+// Standard libraries without <format> (libstdc++ before 13) can use {fmt}
+// instead by defining STRING_FORMAT_FMT; string_format::format_lib names
+// whichever library is in use.
+
+namespace string_format {
+
+// Upper bound on the characters to_chars writes for an integer of type T
+// in the given base: one digit per bit in base 2, plus a sign.
+template <typename T> inline constexpr size_t max_int_chars(int base) {
+  return base == 10 ? std::numeric_limits<T>::digits10 + 2
+                    : std::numeric_limits<T>::digits + 2;
+}
+
+// Enough for the shortest form of any double, such as
+// "-2.2250738585072014e-308"; longer output (long double, a large
+// precision) is retried with more room.
+inline constexpr size_t float_chars = 32;
+
+// Runs write(first, last) -> std::to_chars_result into the string's spare
+// room, growing the room until the result fits.
+template <typename CharT, typename Traits, typename Allocator, typename Write>
+inline void append_chars(BasicString<CharT, Traits, Allocator> &str,
+                         size_t room, Write write) {
+  for (;; room *= 2) {
+    if constexpr (std::is_same_v<CharT, char>) {
+      char *out = str.reserve_append(room);
+      std::to_chars_result result = write(out, out + room);
+      if (result.ec == std::errc()) {
+        str.commit_append(static_cast<size_t>(result.ptr - out));
+        return;
+      }
+    } else {
+      char stack[256];
+      std::unique_ptr<char[]> heap;
+      char *out = stack;
+      if (room > sizeof(stack)) {
+        heap.reset(new char[room]);
+        out = heap.get();
+      }
+      std::to_chars_result result = write(out, out + room);
+      if (result.ec == std::errc()) {
+        size_t len = static_cast<size_t>(result.ptr - out);
+        CharT *dest = str.reserve_append(len);
+        for (size_t i = 0; i < len; ++i)
+          dest[i] = static_cast<CharT>(out[i]);
+        str.commit_append(len);
+        return;
+      }
+    }
+  }
+}
+
+} // namespace string_format
+
+template <typename CharT, typename Traits, typename Allocator,
+          std::integral T>
+  requires(!std::is_same_v<T, bool>)
+inline BasicString<CharT, Traits, Allocator> &
+append_int(BasicString<CharT, Traits, Allocator> &str, T value,
+           int base = 10) {
+  string_format::append_chars(
+      str, string_format::max_int_chars<T>(base),
+      [&](char *first, char *last) {
+        return std::to_chars(first, last, value, base);
+      });
+  return str;
+}
+
+template <typename CharT, typename Traits, typename Allocator,
+          std::floating_point T>
+inline BasicString<CharT, Traits, Allocator> &
+append_float(BasicString<CharT, Traits, Allocator> &str, T value) {
+  string_format::append_chars(str, string_format::float_chars,
+                              [&](char *first, char *last) {
+                                return std::to_chars(first, last, value);
+                              });
+  return str;
+}
+
+template <typename CharT, typename Traits, typename Allocator,
+          std::floating_point T>
+inline BasicString<CharT, Traits, Allocator> &
+append_float(BasicString<CharT, Traits, Allocator> &str, T value,
+             std::chars_format format) {
+  string_format::append_chars(
+      str, string_format::float_chars, [&](char *first, char *last) {
+        return std::to_chars(first, last, value, format);
+      });
+  return str;
+}
+
+template <typename CharT, typename Traits, typename Allocator,
+          std::floating_point T>
+inline BasicString<CharT, Traits, Allocator> &
+append_float(BasicString<CharT, Traits, Allocator> &str, T value,
+             std::chars_format format, int precision) {
+  string_format::append_chars(
+      str, string_format::float_chars, [&](char *first, char *last) {
+        return std::to_chars(first, last, value, format, precision);
+      });
+  return str;
+}
+
+#ifdef STRING_FORMAT_ENABLED
+
+namespace string_format {
+#ifdef STRING_FORMAT_STD
+namespace format_lib = ::std;
+#else
+namespace format_lib = ::fmt;
+#endif
+} // namespace string_format
+
+// Formats like the string_view formatter, so width, fill and precision
+// specifications apply.
+template <typename CharT, typename Traits, typename Allocator>
+struct string_format::format_lib::formatter<
+    BasicString<CharT, Traits, Allocator>, CharT>
+    : string_format::format_lib::formatter<std::basic_string_view<CharT>,
+                                           CharT> {
+  template <typename FormatContext>
+  auto format(const BasicString<CharT, Traits, Allocator> &str,
+              FormatContext &ctx) const {
+    return string_format::format_lib::formatter<
+        std::basic_string_view<CharT>,
+        CharT>::format(std::basic_string_view<CharT>(str.data(), str.size()),
+                       ctx);
+  }
+};
+
+namespace string_format {
+
+// Room offered to format_to_n before the size of the output is known.
+inline constexpr size_t min_format_room = 64;
+
+} // namespace string_format
+
+// Appends the formatted arguments. The first attempt writes into the
+// string's spare capacity (at least min_format_room characters); output
+// that does not fit is formatted again into room of exactly its size.
+template <typename Allocator, typename... Args>
+inline BasicString<char, std::char_traits<char>, Allocator> &
+append_format(BasicString<char, std::char_traits<char>, Allocator> &str,
+              string_format::format_lib::format_string<Args...> fmt,
+              Args &&...args) {
+  size_t room = std::max(str.capacity() - str.size(),
+                         string_format::min_format_room);
+  char *out = str.reserve_append(room);
+  auto result = string_format::format_lib::format_to_n(
+      out, static_cast<std::ptrdiff_t>(room), fmt,
+      std::forward<Args>(args)...);
+  auto len = static_cast<size_t>(result.size);
+  if (len > room) {
+    out = str.reserve_append(len);
+    string_format::format_lib::format_to(out, fmt, std::forward<Args>(args)...);
+  }
+  str.commit_append(len);
+  return str;
+}
+
+#endif
+
+#endif
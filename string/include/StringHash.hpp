@@ -0,0 +1,158 @@
+#ifndef STRING_HASH_H
+#define STRING_HASH_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// 64-bit byte hash used by std::hash<BasicString> and BasicStringHash. It
+// follows wyhash: inputs up to 16 bytes are read with at most four
+// overlapping loads and no loop, longer ones run three independent
+// multiply-xor lanes over 48-byte blocks that the compiler can interleave.
+namespace string_hash {
+
+inline constexpr uint64_t secret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull};
+
+inline constexpr void multiply(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = static_cast<__uint128_t>(*a) * *b;
+  *a = static_cast<uint64_t>(r);
+  *b = static_cast<uint64_t>(r >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32;
+  uint64_t la = static_cast<uint32_t>(*a), lb = static_cast<uint32_t>(*b);
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t carry = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  carry += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+inline constexpr uint64_t mix(uint64_t a, uint64_t b) {
+  multiply(&a, &b);
+  return a ^ b;
+}
+
+// Reads the bytes of the input directly; used at run time.
+struct byte_reader {
+  const unsigned char *p;
+
+  uint64_t byte(size_t i) const { return p[i]; }
+
+  uint64_t read64(size_t i) const {
+    uint64_t v;
+    std::memcpy(&v, p + i, sizeof(v));
+    return v;
+  }
+
+  uint64_t read32(size_t i) const {
+    uint32_t v;
+    std::memcpy(&v, p + i, sizeof(v));
+    return v;
+  }
+};
+
+// Rebuilds the little-endian bytes of a character array one character at
+// a time. Constant evaluation cannot look at an object's bytes, so this is
+// how hash_chars runs at compile time, and it agrees with byte_reader on
+// little-endian targets.
+template <typename CharT> struct char_reader {
+  const CharT *p;
+
+  constexpr uint64_t byte(size_t i) const {
+    using unsigned_type = std::make_unsigned_t<CharT>;
+    auto ch = static_cast<unsigned_type>(p[i / sizeof(CharT)]);
+    return (static_cast<uint64_t>(ch) >> (8 * (i % sizeof(CharT)))) & 0xFF;
+  }
+
+  constexpr uint64_t read(size_t i, size_t bytes) const {
+    uint64_t v = 0;
+    for (size_t k = 0; k < bytes; ++k)
+      v |= byte(i + k) << (8 * k);
+    return v;
+  }
+
+  constexpr uint64_t read64(size_t i) const { return read(i, 8); }
+  constexpr uint64_t read32(size_t i) const { return read(i, 4); }
+};
+
+template <typename Reader>
+inline constexpr uint64_t read_small(const Reader &in, size_t k) {
+  return (in.byte(0) << 16) | (in.byte(k >> 1) << 8) | in.byte(k - 1);
+}
+
+template <typename Reader>
+inline constexpr uint64_t hash_with(const Reader &in, size_t len,
+                                    uint64_t seed) {
+  seed ^= mix(seed ^ secret[0], secret[1]);
+
+  uint64_t a;
+  uint64_t b;
+  if (len <= 16) {
+    if (len >= 4) {
+      size_t shift = (len >> 3) << 2;
+      a = (in.read32(0) << 32) | in.read32(shift);
+      b = (in.read32(len - 4) << 32) | in.read32(len - 4 - shift);
+    } else if (len > 0) {
+      a = read_small(in, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t p = 0;
+    size_t i = len;
+    if (i > 48) {
+      uint64_t lane1 = seed;
+      uint64_t lane2 = seed;
+      do {
+        seed = mix(in.read64(p) ^ secret[1], in.read64(p + 8) ^ seed);
+        lane1 = mix(in.read64(p + 16) ^ secret[2], in.read64(p + 24) ^ lane1);
+        lane2 = mix(in.read64(p + 32) ^ secret[3], in.read64(p + 40) ^ lane2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= lane1 ^ lane2;
+    }
+    while (i > 16) {
+      seed = mix(in.read64(p) ^ secret[1], in.read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = in.read64(p + i - 16);
+    b = in.read64(p + i - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  multiply(&a, &b);
+  return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+inline uint64_t hash_bytes(const void *data, size_t len, uint64_t seed = 0) {
+  return hash_with(byte_reader{static_cast<const unsigned char *>(data)}, len,
+                   seed);
+}
+
+// Hash of the bytes of n characters. Gives the same value in constant
+// expressions as at run time, so tables keyed by it can be built at
+// compile time.
+template <typename CharT>
+inline constexpr uint64_t hash_chars(const CharT *str, size_t n,
+                                     uint64_t seed = 0) {
+  if (std::is_constant_evaluated() ||
+      std::endian::native != std::endian::little)
+    return hash_with(char_reader<CharT>{str}, n * sizeof(CharT), seed);
+  return hash_bytes(str, n * sizeof(CharT), seed);
+}
+
+} // namespace string_hash
+
+#endif
@@ -0,0 +1,740 @@
+#ifndef STRING_SEARCH_H
+#define STRING_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if !defined(STRING_NO_SIMD) && defined(__GNUC__) &&                           \
+    (defined(__x86_64__) || defined(__i386__))
+#define STRING_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+// Substring search kernels behind BasicString::find. Every function returns
+// the offset of the first match in the haystack or string_search::npos.
+//
+// For plain char strings the search filters candidate positions 16 or 32 at
+// a time by comparing the first and last needle characters (SSE2 or AVX2,
+// picked at runtime) and verifies the survivors with memcmp. For needles of
+// at least two_way_min_needle characters the verification work is metered;
+// once it outgrows the scanned input the search continues with the Two-Way
+// algorithm, so long needles stay linear in the worst case. Other character
+// types and traits, and constant evaluation, use the scalar paths, as does
+// every string on targets other than x86 or when STRING_NO_SIMD is defined.
+namespace string_search {
+
+inline constexpr size_t npos = static_cast<size_t>(-1);
+inline constexpr size_t two_way_min_needle = 64;
+
+template <typename CharT, typename Traits>
+inline constexpr size_t find_scalar(const CharT *hay, size_t n,
+                                    const CharT *needle, size_t m,
+                                    size_t start = 0) {
+  if (m == 0)
+    return start <= n ? start : npos;
+  if (m > n)
+    return npos;
+
+  const CharT *p = hay + start;
+  const CharT *last = hay + (n - m);
+  while (p <= last) {
+    p = Traits::find(p, static_cast<size_t>(last - p) + 1, needle[0]);
+    if (p == nullptr)
+      return npos;
+    if (Traits::compare(p + 1, needle + 1, m - 1) == 0)
+      return static_cast<size_t>(p - hay);
+    ++p;
+  }
+  return npos;
+}
+
+// Crochemore-Perrin critical factorization: returns the split point of the
+// needle and stores the period of its right half in *period.
+template <typename CharT, typename Traits>
+inline constexpr size_t critical_factorization(const CharT *needle, size_t m,
+                                               size_t *period) {
+  if (m < 3) {
+    *period = 1;
+    return m - 1;
+  }
+
+  size_t max_suffix = npos;
+  size_t j = 0;
+  size_t k = 1;
+  size_t p = 1;
+  while (j + k < m) {
+    CharT a = needle[j + k];
+    CharT b = needle[max_suffix + k];
+    if (Traits::lt(a, b)) {
+      j += k;
+      k = 1;
+      p = j - max_suffix;
+    } else if (Traits::eq(a, b)) {
+      if (k != p) {
+        ++k;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      max_suffix = j++;
+      k = p = 1;
+    }
+  }
+  *period = p;
+
+  size_t max_suffix_rev = npos;
+  j = 0;
+  k = p = 1;
+  while (j + k < m) {
+    CharT a = needle[j + k];
+    CharT b = needle[max_suffix_rev + k];
+    if (Traits::lt(b, a)) {
+      j += k;
+      k = 1;
+      p = j - max_suffix_rev;
+    } else if (Traits::eq(a, b)) {
+      if (k != p) {
+        ++k;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      max_suffix_rev = j++;
+      k = p = 1;
+    }
+  }
+
+  if (max_suffix_rev + 1 < max_suffix + 1)
+    return max_suffix + 1;
+  *period = p;
+  return max_suffix_rev + 1;
+}
+
+template <typename CharT, typename Traits>
+inline constexpr size_t find_two_way(const CharT *hay, size_t n,
+                                     const CharT *needle, size_t m) {
+  if (m == 0)
+    return 0;
+  if (m > n)
+    return npos;
+
+  size_t period;
+  size_t suffix = critical_factorization<CharT, Traits>(needle, m, &period);
+
+  if (Traits::compare(needle, needle + period, suffix) == 0) {
+    // Periodic needle: remember how much of the left half already matched.
+    size_t memory = 0;
+    size_t j = 0;
+    while (j <= n - m) {
+      size_t i = suffix > memory ? suffix : memory;
+      while (i < m && Traits::eq(needle[i], hay[i + j]))
+        ++i;
+      if (i >= m) {
+        i = suffix - 1;
+        while (memory < i + 1 && Traits::eq(needle[i], hay[i + j]))
+          --i;
+        if (i + 1 < memory + 1)
+          return j;
+        j += period;
+        memory = m - period;
+      } else {
+        j += i - suffix + 1;
+        memory = 0;
+      }
+    }
+  } else {
+    period = (suffix > m - suffix ? suffix : m - suffix) + 1;
+    size_t j = 0;
+    while (j <= n - m) {
+      size_t i = suffix;
+      while (i < m && Traits::eq(needle[i], hay[i + j]))
+        ++i;
+      if (i >= m) {
+        i = suffix - 1;
+        while (i != npos && Traits::eq(needle[i], hay[i + j]))
+          --i;
+        if (i == npos)
+          return j;
+        j += period;
+      } else {
+        j += i - suffix + 1;
+      }
+    }
+  }
+  return npos;
+}
+
+// Budget of characters the filter kernels may spend verifying candidates
+// after scanning i positions before they hand over to Two-Way.
+inline size_t verify_budget(size_t i, size_t m) { return 4 * i + 16 * m; }
+
+inline size_t two_way_tail(const char *hay, size_t n, const char *needle,
+                           size_t m, size_t start) {
+  size_t found = find_two_way<char, std::char_traits<char>>(
+      hay + start, n - start, needle, m);
+  return found == npos ? npos : found + start;
+}
+
+#ifdef STRING_SEARCH_X86
+
+// Both kernels expect 2 <= m <= n and finish the last partial block with the
+// scalar search.
+inline size_t find_sse2(const char *hay, size_t n, const char *needle,
+                        size_t m) {
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[m - 1]);
+  const bool metered = m >= two_way_min_needle;
+  size_t verified = 0;
+
+  size_t i = 0;
+  for (; i + m - 1 + 16 <= n; i += 16) {
+    __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i));
+    __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i + m - 1));
+    unsigned mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                        _mm_cmpeq_epi8(last, block_last))));
+    while (mask != 0) {
+      size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+      if (std::memcmp(hay + pos + 1, needle + 1, m - 2) == 0)
+        return pos;
+      verified += m;
+      mask &= mask - 1;
+    }
+
+    if (metered && verified > verify_budget(i, m))
+      return two_way_tail(hay, n, needle, m, i);
+  }
+
+  return find_scalar<char, std::char_traits<char>>(hay, n, needle, m, i);
+}
+
+__attribute__((target("avx2"))) inline size_t
+find_avx2(const char *hay, size_t n, const char *needle, size_t m) {
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+  const bool metered = m >= two_way_min_needle;
+  size_t verified = 0;
+
+  size_t i = 0;
+  for (; i + m - 1 + 32 <= n; i += 32) {
+    __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hay + i));
+    __m256i block_last =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hay + i + m - 1));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                         _mm256_cmpeq_epi8(last, block_last))));
+    while (mask != 0) {
+      size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+      if (std::memcmp(hay + pos + 1, needle + 1, m - 2) == 0)
+        return pos;
+      verified += m;
+      mask &= mask - 1;
+    }
+
+    if (metered && verified > verify_budget(i, m))
+      return two_way_tail(hay, n, needle, m, i);
+  }
+
+  return find_scalar<char, std::char_traits<char>>(hay, n, needle, m, i);
+}
+
+#endif
+
+using find_kernel = size_t (*)(const char *, size_t, const char *, size_t);
+
+inline size_t find_portable(const char *hay, size_t n, const char *needle,
+                            size_t m) {
+  return find_scalar<char, std::char_traits<char>>(hay, n, needle, m, 0);
+}
+
+inline find_kernel select_find_kernel() {
+#ifdef STRING_SEARCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return find_avx2;
+  return find_sse2;
+#else
+  return find_portable;
+#endif
+}
+
+inline size_t find_bytes(const char *hay, size_t n, const char *needle,
+                         size_t m) {
+  if (m == 0)
+    return 0;
+  if (m > n)
+    return npos;
+  if (m == 1) {
+    const void *p = std::memchr(hay, needle[0], n);
+    return p ? static_cast<size_t>(static_cast<const char *>(p) - hay) : npos;
+  }
+#ifndef STRING_SEARCH_X86
+  if (m >= two_way_min_needle)
+    return find_two_way<char, std::char_traits<char>>(hay, n, needle, m);
+#endif
+
+  static const find_kernel kernel = select_find_kernel();
+  return kernel(hay, n, needle, m);
+}
+
+// Entry point used by BasicString: bytes compared with the standard traits
+// take the vectorized path, everything else the scalar ones.
+template <typename CharT, typename Traits>
+inline constexpr size_t find(const CharT *hay, size_t n, const CharT *needle,
+                             size_t m) {
+  if constexpr (std::is_same_v<CharT, char> &&
+                std::is_same_v<Traits, std::char_traits<char>>) {
+    if (!std::is_constant_evaluated())
+      return find_bytes(hay, n, needle, m);
+  }
+  if (m >= two_way_min_needle)
+    return find_two_way<CharT, Traits>(hay, n, needle, m);
+  return find_scalar<CharT, Traits>(hay, n, needle, m);
+}
+
+// Character-set scanning. A byte_set answers membership from a 256-bit
+// bitmap and also carries tables for looking bytes up 16 or 32 at a time
+// with pshufb (SSSE3 or AVX2, picked at runtime):
+//
+//  - sets of one to three distinct bytes are compared against each byte;
+//  - when the set's bytes use at most eight distinct high nibbles (any set
+//    of ASCII characters does), each high nibble owns one bit, set in the
+//    low-nibble entries of its members, and a byte is looked up by
+//    shuffling both nibble tables and and-ing the results;
+//  - any other set uses two row tables, one for bytes below 0x80 and one
+//    for the rest, holding a bit per high nibble for each low nibble; the
+//    byte's row is and-ed with the bit for its high nibble.
+//
+// Scans run forward or backward, for bytes in the set or for bytes outside
+// it. Without SSSE3, on targets other than x86 and under STRING_NO_SIMD
+// they test one byte at a time against the bitmap.
+struct byte_set {
+  uint64_t bits[4] = {};
+  uint8_t low[16] = {};
+  uint8_t high[16] = {};
+  bool nibble_tables = true;
+  uint8_t rows[2][16] = {};
+  // Sets of one to three distinct bytes list them here and are scanned by
+  // comparing against each; small_count is 0 for larger sets.
+  uint8_t small[3] = {};
+  uint8_t small_count = 0;
+
+  constexpr byte_set() = default;
+
+  constexpr byte_set(const char *chars, size_t n) {
+    int buckets = 0;
+    size_t distinct = 0;
+    for (size_t i = 0; i < n; ++i) {
+      auto ch = static_cast<unsigned char>(chars[i]);
+      if (contains(ch))
+        continue;
+      if (distinct < 3)
+        small[distinct] = ch;
+      ++distinct;
+      bits[ch >> 6] |= uint64_t(1) << (ch & 63);
+      rows[ch >> 7][ch & 15] |= static_cast<uint8_t>(1u << ((ch >> 4) & 7));
+      size_t hi = ch >> 4;
+      if (high[hi] == 0) {
+        if (buckets == 8) {
+          nibble_tables = false;
+          continue;
+        }
+        high[hi] = static_cast<uint8_t>(1u << buckets++);
+      }
+      low[ch & 15] |= high[hi];
+    }
+    small_count = distinct <= 3 ? static_cast<uint8_t>(distinct) : 0;
+  }
+
+  constexpr bool contains(unsigned char ch) const {
+    return (bits[ch >> 6] >> (ch & 63)) & 1;
+  }
+};
+
+// Offset of the first byte of str[i..n) whose membership in set is Member,
+// or npos.
+template <bool Member>
+inline constexpr size_t scan_forward_scalar(const char *str, size_t n,
+                                            const byte_set &set,
+                                            size_t i = 0) {
+  for (; i < n; ++i) {
+    if (set.contains(static_cast<unsigned char>(str[i])) == Member)
+      return i;
+  }
+  return npos;
+}
+
+// Same for the last such byte of str[0..n).
+template <bool Member>
+inline constexpr size_t scan_backward_scalar(const char *str, size_t n,
+                                             const byte_set &set) {
+  while (n-- > 0) {
+    if (set.contains(static_cast<unsigned char>(str[n])) == Member)
+      return n;
+  }
+  return npos;
+}
+
+inline constexpr size_t find_any_scalar(const char *str, size_t n,
+                                        const byte_set &set, size_t i = 0) {
+  return scan_forward_scalar<true>(str, n, set, i);
+}
+
+#ifdef STRING_SEARCH_X86
+
+// How the vector kernels test a byte: 1 to 3 compare against set.small,
+// the others look it up in the tables.
+inline constexpr int match_nibbles = 0;
+inline constexpr int match_rows = 4;
+
+// The bit of each high nibble within its row.
+inline constexpr uint8_t row_bits[16] = {1, 2, 4,  8,  16, 32, 64, 128,
+                                         1, 2, 4,  8,  16, 32, 64, 128};
+
+inline int match_mode(const byte_set &set) {
+  if (set.small_count != 0)
+    return set.small_count;
+  return set.nibble_tables ? match_nibbles : match_rows;
+}
+
+// Bit i is set when byte i of block is in the set. a, b and c hold the
+// bytes of set.small, the nibble tables or the row tables and row_bits,
+// as Mode says.
+template <int Mode>
+__attribute__((target("avx2"))) inline uint32_t
+set_mask_avx2(__m256i block, __m256i a, __m256i b, __m256i c) {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  if constexpr (Mode == match_nibbles) {
+    __m256i low = _mm256_shuffle_epi8(a, _mm256_and_si256(block, nibble));
+    __m256i high = _mm256_shuffle_epi8(
+        b, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+        _mm256_and_si256(low, high), _mm256_setzero_si256())));
+  } else if constexpr (Mode == match_rows) {
+    // pshufb yields zero for indexes with the top bit set, so each row
+    // table only answers for its half of the bytes.
+    __m256i index =
+        _mm256_and_si256(block, _mm256_set1_epi8(static_cast<char>(0x8F)));
+    __m256i row = _mm256_or_si256(
+        _mm256_shuffle_epi8(a, index),
+        _mm256_shuffle_epi8(
+            b, _mm256_xor_si256(index,
+                                _mm256_set1_epi8(static_cast<char>(0x80)))));
+    __m256i bit = _mm256_shuffle_epi8(
+        c, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+        _mm256_and_si256(row, bit), _mm256_setzero_si256())));
+  } else {
+    __m256i hits = _mm256_cmpeq_epi8(block, a);
+    if constexpr (Mode > 1)
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, b));
+    if constexpr (Mode > 2)
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, c));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+  }
+}
+
+__attribute__((target("avx2"))) inline __m256i
+load_table_avx2(const uint8_t (&table)[16]) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(table)));
+}
+
+// Scans 32 bytes at a time from the front or, for Reverse, from the back;
+// the leftover bytes at the far end go through the scalar loop.
+template <bool Member, bool Reverse, int Mode>
+__attribute__((target("avx2"))) inline size_t
+scan_avx2_blocks(const char *str, size_t n, const byte_set &set) {
+  __m256i a, b, c;
+  if constexpr (Mode == match_nibbles) {
+    a = load_table_avx2(set.low);
+    b = load_table_avx2(set.high);
+    c = _mm256_setzero_si256();
+  } else if constexpr (Mode == match_rows) {
+    a = load_table_avx2(set.rows[0]);
+    b = load_table_avx2(set.rows[1]);
+    c = load_table_avx2(row_bits);
+  } else {
+    a = _mm256_set1_epi8(static_cast<char>(set.small[0]));
+    b = _mm256_set1_epi8(static_cast<char>(set.small[1]));
+    c = _mm256_set1_epi8(static_cast<char>(set.small[2]));
+  }
+
+  if constexpr (!Reverse) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+      uint32_t hits = set_mask_avx2<Mode>(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i)), a,
+          b, c);
+      if constexpr (!Member)
+        hits = ~hits;
+      if (hits != 0)
+        return i + static_cast<size_t>(__builtin_ctz(hits));
+    }
+    return scan_forward_scalar<Member>(str, n, set, i);
+  } else {
+    size_t i = n;
+    for (; i >= 32; i -= 32) {
+      uint32_t hits = set_mask_avx2<Mode>(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i - 32)),
+          a, b, c);
+      if constexpr (!Member)
+        hits = ~hits;
+      if (hits != 0)
+        return i - 1 - static_cast<size_t>(__builtin_clz(hits));
+    }
+    return scan_backward_scalar<Member>(str, i, set);
+  }
+}
+
+template <bool Member, bool Reverse>
+__attribute__((target("avx2"))) inline size_t
+scan_avx2(const char *str, size_t n, const byte_set &set) {
+  switch (match_mode(set)) {
+  case 1:
+    return scan_avx2_blocks<Member, Reverse, 1>(str, n, set);
+  case 2:
+    return scan_avx2_blocks<Member, Reverse, 2>(str, n, set);
+  case 3:
+    return scan_avx2_blocks<Member, Reverse, 3>(str, n, set);
+  case match_nibbles:
+    return scan_avx2_blocks<Member, Reverse, match_nibbles>(str, n, set);
+  default:
+    return scan_avx2_blocks<Member, Reverse, match_rows>(str, n, set);
+  }
+}
+
+// The same lookups 16 bytes at a time, for CPUs with SSSE3 but not AVX2.
+template <int Mode>
+__attribute__((target("ssse3"))) inline uint32_t
+set_mask_ssse3(__m128i block, __m128i a, __m128i b, __m128i c) {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  if constexpr (Mode == match_nibbles) {
+    __m128i low = _mm_shuffle_epi8(a, _mm_and_si128(block, nibble));
+    __m128i high =
+        _mm_shuffle_epi8(b, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+               _mm_and_si128(low, high), _mm_setzero_si128()))) ^
+           0xFFFF;
+  } else if constexpr (Mode == match_rows) {
+    __m128i index =
+        _mm_and_si128(block, _mm_set1_epi8(static_cast<char>(0x8F)));
+    __m128i row = _mm_or_si128(
+        _mm_shuffle_epi8(a, index),
+        _mm_shuffle_epi8(
+            b, _mm_xor_si128(index, _mm_set1_epi8(static_cast<char>(0x80)))));
+    __m128i bit =
+        _mm_shuffle_epi8(c, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+               _mm_and_si128(row, bit), _mm_setzero_si128()))) ^
+           0xFFFF;
+  } else {
+    __m128i hits = _mm_cmpeq_epi8(block, a);
+    if constexpr (Mode > 1)
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, b));
+    if constexpr (Mode > 2)
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, c));
+    return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+  }
+}
+
+__attribute__((target("ssse3"))) inline __m128i
+load_table_ssse3(const uint8_t (&table)[16]) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(table));
+}
+
+template <bool Member, bool Reverse, int Mode>
+__attribute__((target("ssse3"))) inline size_t
+scan_ssse3_blocks(const char *str, size_t n, const byte_set &set) {
+  __m128i a, b, c;
+  if constexpr (Mode == match_nibbles) {
+    a = load_table_ssse3(set.low);
+    b = load_table_ssse3(set.high);
+    c = _mm_setzero_si128();
+  } else if constexpr (Mode == match_rows) {
+    a = load_table_ssse3(set.rows[0]);
+    b = load_table_ssse3(set.rows[1]);
+    c = load_table_ssse3(row_bits);
+  } else {
+    a = _mm_set1_epi8(static_cast<char>(set.small[0]));
+    b = _mm_set1_epi8(static_cast<char>(set.small[1]));
+    c = _mm_set1_epi8(static_cast<char>(set.small[2]));
+  }
+
+  if constexpr (!Reverse) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+      uint32_t hits = set_mask_ssse3<Mode>(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i)), a, b,
+          c);
+      if constexpr (!Member)
+        hits ^= 0xFFFF;
+      if (hits != 0)
+        return i + static_cast<size_t>(__builtin_ctz(hits));
+    }
+    return scan_forward_scalar<Member>(str, n, set, i);
+  } else {
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+      uint32_t hits = set_mask_ssse3<Mode>(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i - 16)), a,
+          b, c);
+      if constexpr (!Member)
+        hits ^= 0xFFFF;
+      if (hits != 0)
+        return i - 16 + 31 - static_cast<size_t>(__builtin_clz(hits));
+    }
+    return scan_backward_scalar<Member>(str, i, set);
+  }
+}
+
+template <bool Member, bool Reverse>
+__attribute__((target("ssse3"))) inline size_t
+scan_ssse3(const char *str, size_t n, const byte_set &set) {
+  switch (match_mode(set)) {
+  case 1:
+    return scan_ssse3_blocks<Member, Reverse, 1>(str, n, set);
+  case 2:
+    return scan_ssse3_blocks<Member, Reverse, 2>(str, n, set);
+  case 3:
+    return scan_ssse3_blocks<Member, Reverse, 3>(str, n, set);
+  case match_nibbles:
+    return scan_ssse3_blocks<Member, Reverse, match_nibbles>(str, n, set);
+  default:
+    return scan_ssse3_blocks<Member, Reverse, match_rows>(str, n, set);
+  }
+}
+
+#endif
+
+using find_any_kernel = size_t (*)(const char *, size_t, const byte_set &);
+
+// A lone byte searched forward is memchr, which must not see the null
+// pointer of an empty view.
+template <bool Member, bool Reverse>
+inline size_t scan_portable(const char *str, size_t n, const byte_set &set) {
+  if constexpr (Reverse) {
+    return scan_backward_scalar<Member>(str, n, set);
+  } else {
+    if (Member && set.small_count == 1 && n != 0) {
+      const void *p = std::memchr(str, set.small[0], n);
+      return p ? static_cast<size_t>(static_cast<const char *>(p) - str)
+               : npos;
+    }
+    return scan_forward_scalar<Member>(str, n, set);
+  }
+}
+
+template <bool Member, bool Reverse>
+inline find_any_kernel select_scan_kernel() {
+#ifdef STRING_SEARCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return scan_avx2<Member, Reverse>;
+  if (__builtin_cpu_supports("ssse3"))
+    return scan_ssse3<Member, Reverse>;
+#endif
+  return scan_portable<Member, Reverse>;
+}
+
+template <bool Member, bool Reverse>
+inline size_t scan_bytes(const char *str, size_t n, const byte_set &set) {
+  static const find_any_kernel kernel = select_scan_kernel<Member, Reverse>();
+  return kernel(str, n, set);
+}
+
+// Offset of the first byte of str[0..n) that is in set, or npos.
+inline size_t find_any_bytes(const char *str, size_t n, const byte_set &set) {
+  return scan_bytes<true, false>(str, n, set);
+}
+
+// Offset of the first byte of str[0..n) that is not in set, or npos.
+inline size_t find_not_any_bytes(const char *str, size_t n,
+                                 const byte_set &set) {
+  return scan_bytes<false, false>(str, n, set);
+}
+
+// Offset of the last byte of str[0..n) that is in set, or npos.
+inline size_t rfind_any_bytes(const char *str, size_t n, const byte_set &set) {
+  return scan_bytes<true, true>(str, n, set);
+}
+
+// Offset of the last byte of str[0..n) that is not in set, or npos.
+inline size_t rfind_not_any_bytes(const char *str, size_t n,
+                                  const byte_set &set) {
+  return scan_bytes<false, true>(str, n, set);
+}
+
+// Entry points for BasicString's rfind and find_*_of family, in the style
+// of find(): plain char strings take the byte_set scans, everything else
+// and constant evaluation the loops over Traits.
+template <typename CharT, typename Traits>
+inline constexpr bool byte_scans =
+    std::is_same_v<CharT, char> &&
+    std::is_same_v<Traits, std::char_traits<char>>;
+
+// Offset of the first character of str[0..n) whose presence in
+// set[0..m) is Member, or npos.
+template <typename CharT, typename Traits, bool Member>
+inline constexpr size_t find_of(const CharT *str, size_t n, const CharT *set,
+                                size_t m) {
+  if constexpr (byte_scans<CharT, Traits>) {
+    if (!std::is_constant_evaluated())
+      return scan_bytes<Member, false>(str, n, byte_set(set, m));
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if ((Traits::find(set, m, str[i]) != nullptr) == Member)
+      return i;
+  }
+  return npos;
+}
+
+// Same for the last such character.
+template <typename CharT, typename Traits, bool Member>
+inline constexpr size_t rfind_of(const CharT *str, size_t n, const CharT *set,
+                                 size_t m) {
+  if constexpr (byte_scans<CharT, Traits>) {
+    if (!std::is_constant_evaluated())
+      return scan_bytes<Member, true>(str, n, byte_set(set, m));
+  }
+  while (n-- > 0) {
+    if ((Traits::find(set, m, str[n]) != nullptr) == Member)
+      return n;
+  }
+  return npos;
+}
+
+// Offset of the last occurrence of needle[0..m) in hay[0..n), or npos.
+// Candidates are found by scanning backward for the needle's first
+// character and checked with compare.
+template <typename CharT, typename Traits>
+inline constexpr size_t rfind(const CharT *hay, size_t n, const CharT *needle,
+                              size_t m) {
+  if (m > n)
+    return npos;
+  if (m == 0)
+    return n;
+
+  size_t end = n - m + 1;
+  while (end > 0) {
+    size_t i = rfind_of<CharT, Traits, true>(hay, end, needle, 1);
+    if (i == npos)
+      return npos;
+    if (Traits::compare(hay + i + 1, needle + 1, m - 1) == 0)
+      return i;
+    end = i;
+  }
+  return npos;
+}
+
+} // namespace string_search
+
+#endif
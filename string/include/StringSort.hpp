@@ -0,0 +1,283 @@
+#ifndef STRING_SORT_H
+#define STRING_SORT_H
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Sorting ranges of strings without comparing them a character at a time.
+// sort_strings() reads each string once into an item holding its data
+// pointer, its length and the next eight bytes as a big-endian number, and
+// runs multikey quicksort on those cached words: items are partitioned
+// into less, equal and greater than a pivot word, and only the equal part
+// moves on to the next eight bytes. Most steps compare integers in a
+// contiguous array instead of following pointers into the strings. The
+// range itself is permuted once at the end.
+//
+//   sort_strings(keys);        // same order as std::ranges::sort(keys)
+//   sort_strings(keys, 8);     // on up to eight threads
+//
+// The parallel mode spreads the partitions left by the top-level steps
+// over the threads, so skewed inputs such as keys sharing a long prefix
+// still split. Elements have to convert to std::string_view (BasicString,
+// GermanString, std::string and views do); other strings, such as wide or
+// case-insensitive ones, are sorted with std::ranges::sort.
+
+namespace string_sort {
+
+// Below this many strings the parallel mode sorts on the calling thread.
+inline constexpr size_t parallel_min_size = 1 << 16;
+// Partitions up to this size are finished with insertion sort.
+inline constexpr size_t insertion_max_size = 16;
+
+struct Item {
+  uint64_t key;
+  const char *data;
+  size_t size;
+  size_t index;
+};
+
+// The eight bytes of str starting at depth, zero-padded past its end, as a
+// number that orders like the bytes.
+inline uint64_t key_at(const char *data, size_t size, size_t depth) {
+  uint64_t key = 0;
+  if (depth < size)
+    std::memcpy(&key, data + depth, std::min<size_t>(size - depth, 8));
+  if constexpr (std::endian::native == std::endian::little)
+    key = __builtin_bswap64(key);
+  return key;
+}
+
+// Items whose keys match at depth differ only past depth + 8.
+inline bool less_from(const Item &lhs, const Item &rhs, size_t depth) {
+  if (lhs.key != rhs.key)
+    return lhs.key < rhs.key;
+  size_t next = depth + 8;
+  size_t lhs_rest = lhs.size > next ? lhs.size - next : 0;
+  size_t rhs_rest = rhs.size > next ? rhs.size - next : 0;
+  size_t len = std::min(lhs_rest, rhs_rest);
+  if (len != 0) {
+    int result = std::memcmp(lhs.data + next, rhs.data + next, len);
+    if (result != 0)
+      return result < 0;
+  }
+  return lhs.size < rhs.size;
+}
+
+inline void insertion_sort(Item *first, Item *last, size_t depth) {
+  for (Item *i = first + 1; i < last; ++i) {
+    Item item = *i;
+    Item *j = i;
+    for (; j > first && less_from(item, j[-1], depth); --j)
+      *j = j[-1];
+    *j = item;
+  }
+}
+
+inline uint64_t median_key(const Item *first, const Item *last) {
+  uint64_t a = first->key;
+  uint64_t b = first[(last - first) / 2].key;
+  uint64_t c = last[-1].key;
+  if (a > b)
+    std::swap(a, b);
+  return c < a ? a : (c > b ? b : c);
+}
+
+// Three-way partition on the cached keys: [first, lt) is less than the
+// pivot, [lt, gt) equal and [gt, last) greater.
+inline std::pair<Item *, Item *> partition(Item *first, Item *last) {
+  uint64_t pivot = median_key(first, last);
+  Item *lt = first;
+  Item *gt = last;
+  for (Item *i = first; i < gt;) {
+    if (i->key < pivot)
+      std::swap(*i++, *lt++);
+    else if (i->key > pivot)
+      std::swap(*i, *--gt);
+    else
+      ++i;
+  }
+  return {lt, gt};
+}
+
+// Finishes the part of an equal run that ends within these eight bytes and
+// loads the next key for the rest, which it returns. The strings that end
+// here match except for how many zero bytes they end with, so they sort by
+// length, and before every string that goes on.
+inline Item *deepen(Item *first, Item *last, size_t depth) {
+  size_t next = depth + 8;
+  Item *rest = std::partition(
+      first, last, [next](const Item &item) { return item.size <= next; });
+  std::sort(first, rest, [](const Item &lhs, const Item &rhs) {
+    return lhs.size < rhs.size;
+  });
+  for (Item *i = rest; i < last; ++i)
+    i->key = key_at(i->data, i->size, next);
+  return rest;
+}
+
+// Of the three parts left by a step, the two smaller ones are sorted
+// recursively and the largest by the next iteration. Neither smaller part
+// holds more than half the items, so the recursion stays logarithmic even
+// when every key shares a long prefix and each step only deepens.
+inline void multikey_sort(Item *first, Item *last, size_t depth) {
+  struct Part {
+    Item *first;
+    Item *last;
+    size_t depth;
+  };
+
+  while (static_cast<size_t>(last - first) > insertion_max_size) {
+    auto [lt, gt] = partition(first, last);
+    Part parts[3] = {{first, lt, depth},
+                     {deepen(lt, gt, depth), gt, depth + 8},
+                     {gt, last, depth}};
+    Part *largest = std::max_element(
+        parts, parts + 3, [](const Part &lhs, const Part &rhs) {
+          return lhs.last - lhs.first < rhs.last - rhs.first;
+        });
+    for (Part &part : parts) {
+      if (&part != largest)
+        multikey_sort(part.first, part.last, part.depth);
+    }
+    first = largest->first;
+    last = largest->last;
+    depth = largest->depth;
+  }
+  insertion_sort(first, last, depth);
+}
+
+// Work queue for the parallel mode. Large tasks are partitioned once and
+// their three parts queued again; small ones are sorted where they are.
+class ParallelSort {
+public:
+  explicit ParallelSort(size_t grain) : grain_(grain) {}
+
+  void run(Item *first, Item *last, size_t threads) {
+    push(first, last, 0);
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t)
+      workers.emplace_back([this] { work(); });
+    work();
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+private:
+  struct Task {
+    Item *first;
+    Item *last;
+    size_t depth;
+  };
+
+  void push(Item *first, Item *last, size_t depth) {
+    if (last - first < 2)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back({first, last, depth});
+    ++pending_;
+    ready_.notify_one();
+  }
+
+  void work() {
+    for (;;) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return !tasks_.empty() || pending_ == 0; });
+        if (tasks_.empty())
+          return;
+        task = tasks_.back();
+        tasks_.pop_back();
+      }
+
+      if (static_cast<size_t>(task.last - task.first) > grain_) {
+        auto [lt, gt] = partition(task.first, task.last);
+        push(task.first, lt, task.depth);
+        push(deepen(lt, gt, task.depth), gt, task.depth + 8);
+        push(gt, task.last, task.depth);
+      } else {
+        multikey_sort(task.first, task.last, task.depth);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0)
+        ready_.notify_all();
+    }
+  }
+
+  size_t grain_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::vector<Task> tasks_;
+  size_t pending_ = 0;
+};
+
+template <typename R>
+concept byte_string_range =
+    std::ranges::random_access_range<R> &&
+    std::is_convertible_v<const std::ranges::range_value_t<R> &,
+                          std::string_view>;
+
+template <typename R> void sort_range(R &&range, size_t threads) {
+  auto first = std::ranges::begin(range);
+  size_t n = static_cast<size_t>(std::ranges::distance(range));
+  if (n < 2)
+    return;
+
+  std::vector<Item> items(n);
+  for (size_t i = 0; i < n; ++i) {
+    std::string_view str = first[i];
+    items[i] = {key_at(str.data(), str.size(), 0), str.data(), str.size(), i};
+  }
+
+  if (threads > 1 && n >= parallel_min_size) {
+    ParallelSort(std::max(n / (threads * 8), insertion_max_size))
+        .run(items.data(), items.data() + n, threads);
+  } else {
+    multikey_sort(items.data(), items.data() + n, 0);
+  }
+
+  using value_type = std::ranges::range_value_t<R>;
+  std::vector<value_type> sorted;
+  sorted.reserve(n);
+  for (const Item &item : items)
+    sorted.push_back(std::move(first[item.index]));
+  std::ranges::move(sorted, first);
+}
+
+} // namespace string_sort
+
+template <std::ranges::random_access_range R>
+  requires std::sortable<std::ranges::iterator_t<R>>
+void sort_strings(R &&range) {
+  if constexpr (string_sort::byte_string_range<R>)
+    string_sort::sort_range(range, 1);
+  else
+    std::ranges::sort(range);
+}
+
+// threads == 0 uses every hardware thread.
+template <std::ranges::random_access_range R>
+  requires std::sortable<std::ranges::iterator_t<R>>
+void sort_strings(R &&range, size_t threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if constexpr (string_sort::byte_string_range<R>)
+    string_sort::sort_range(range, threads);
+  else
+    std::ranges::sort(range);
+}
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef STRING_SPLIT_H
+#define STRING_SPLIT_H
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+
+#include "BasicString.hpp"
+#include "StringSearch.hpp"
+
+// Lazy splitting of a string into string_views of its own buffer. Nothing
+// is copied or allocated: each step of the iterator looks for the next
+// delimiter, so a loop that stops early never scans the rest.
+//
+//   for (std::string_view field : split(line, ','))
+//   for (std::string_view word : tokenize(text, " \t\n"))
+//
+// split() keeps empty fields, so "a,,b" gives "a", "", "b" and an empty
+// string gives one empty field. tokenize() splits on any character of a set
+// and drops the empty fields, so runs of separators count as one. The
+// string has to outlive the range.
+
+// Matches one character. Plain char strings search with memchr.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class CharDelimiter {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  constexpr explicit CharDelimiter(CharT ch) noexcept : ch_(ch) {}
+
+  constexpr size_t find(view_type text, size_t pos) const noexcept {
+    return text.find(ch_, pos);
+  }
+  constexpr size_t size() const noexcept { return 1; }
+
+private:
+  CharT ch_;
+};
+
+// Matches a whole string, found with the same kernels as BasicString::find.
+// An empty delimiter never matches. The characters are copied, so the
+// delimiter may be a temporary; it usually fits the inline buffer.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class StringDelimiter {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  constexpr explicit StringDelimiter(view_type delim) : delim_(delim) {}
+
+  constexpr size_t find(view_type text, size_t pos) const noexcept {
+    if (delim_.empty())
+      return view_type::npos;
+    size_t found = string_search::find<CharT, Traits>(
+        text.data() + pos, text.size() - pos, delim_.data(), delim_.size());
+    return found == string_search::npos ? view_type::npos : found + pos;
+  }
+  constexpr size_t size() const noexcept { return delim_.size(); }
+
+private:
+  BasicString<CharT, Traits> delim_;
+};
+
+// Matches any one character of a set. For plain char strings the set is
+// turned into a string_search::byte_set and scanned 32 bytes at a time;
+// other character types compare against a copy of the set's characters.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class AnyOfDelimiter {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  constexpr explicit AnyOfDelimiter(view_type chars) : chars_(chars) {
+    if constexpr (byte_scan)
+      set_ = string_search::byte_set(chars.data(), chars.size());
+  }
+
+  constexpr size_t find(view_type text, size_t pos) const noexcept {
+    if constexpr (byte_scan) {
+      if (!std::is_constant_evaluated()) {
+        size_t found = string_search::find_any_bytes(
+            text.data() + pos, text.size() - pos, set_);
+        return found == string_search::npos ? view_type::npos : found + pos;
+      }
+    }
+    return text.find_first_of(view_type(chars_), pos);
+  }
+  constexpr size_t size() const noexcept { return 1; }
+
+private:
+  static constexpr bool byte_scan =
+      std::is_same_v<CharT, char> &&
+      std::is_same_v<Traits, std::char_traits<char>>;
+
+  BasicString<CharT, Traits> chars_;
+  string_search::byte_set set_;
+};
+
+template <typename CharT>
+AnyOfDelimiter(const CharT *) -> AnyOfDelimiter<CharT>;
+
+// Forward range of the fields of a string. Delimiter is one of the classes
+// above, or anything with find(view, pos) and size() members that behave
+// the same way.
+template <typename CharT, typename Traits, typename Delimiter,
+          bool SkipEmpty = false>
+class SplitView : public std::ranges::view_interface<
+                      SplitView<CharT, Traits, Delimiter, SkipEmpty>> {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+
+  class iterator {
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = view_type;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    constexpr view_type operator*() const noexcept {
+      return parent_->text_.substr(pos_, end_ - pos_);
+    }
+
+    constexpr iterator &operator++() {
+      advance();
+      skip_empty();
+      return *this;
+    }
+
+    constexpr iterator operator++(int) {
+      iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    constexpr bool operator==(const iterator &other) const noexcept {
+      return pos_ == other.pos_;
+    }
+
+  private:
+    friend class SplitView;
+
+    static constexpr size_t done = view_type::npos;
+
+    constexpr iterator(const SplitView *parent, size_t pos) noexcept
+        : parent_(parent), pos_(pos) {
+      if (pos_ != done) {
+        find_end();
+        skip_empty();
+      }
+    }
+
+    // The field starting at pos_ runs to the next delimiter or the end.
+    constexpr void find_end() {
+      size_t found = parent_->delim_.find(parent_->text_, pos_);
+      last_ = found == view_type::npos;
+      end_ = last_ ? parent_->text_.size() : found;
+    }
+
+    constexpr void advance() {
+      if (last_) {
+        pos_ = done;
+        return;
+      }
+      pos_ = end_ + parent_->delim_.size();
+      find_end();
+    }
+
+    constexpr void skip_empty() {
+      if constexpr (SkipEmpty) {
+        while (pos_ != done && end_ == pos_)
+          advance();
+      }
+    }
+
+    const SplitView *parent_ = nullptr;
+    size_t pos_ = done;
+    size_t end_ = done;
+    bool last_ = true;
+  };
+
+  constexpr SplitView(view_type text, Delimiter delim)
+      : text_(text), delim_(std::move(delim)) {}
+
+  constexpr iterator begin() const { return iterator(this, 0); }
+  constexpr iterator end() const { return iterator(this, iterator::done); }
+
+private:
+  view_type text_;
+  Delimiter delim_;
+};
+
+namespace string_split {
+
+// Picks the delimiter class for what split() was given: a character,
+// something that converts to a string view, or a ready-made delimiter.
+template <typename CharT, typename Traits, typename Delim>
+constexpr auto make_delimiter(Delim &&delim) {
+  using plain = std::remove_cvref_t<Delim>;
+  if constexpr (std::is_same_v<plain, CharT>) {
+    return CharDelimiter<CharT, Traits>(delim);
+  } else if constexpr (std::is_convertible_v<
+                           const plain &,
+                           std::basic_string_view<CharT, Traits>>) {
+    return StringDelimiter<CharT, Traits>(
+        std::basic_string_view<CharT, Traits>(delim));
+  } else {
+    return plain(std::forward<Delim>(delim));
+  }
+}
+
+template <typename CharT, typename Traits, typename Delim>
+using delimiter_t = decltype(make_delimiter<CharT, Traits>(
+    std::declval<Delim>()));
+
+} // namespace string_split
+
+template <typename CharT, typename Traits, typename Delim>
+constexpr SplitView<CharT, Traits,
+                    string_split::delimiter_t<CharT, Traits, Delim>>
+split(std::basic_string_view<CharT, Traits> text, Delim &&delim) {
+  return {text, string_split::make_delimiter<CharT, Traits>(
+                    std::forward<Delim>(delim))};
+}
+
+template <typename CharT, typename Traits, typename Allocator, typename Delim>
+constexpr SplitView<CharT, Traits,
+                    string_split::delimiter_t<CharT, Traits, Delim>>
+split(const BasicString<CharT, Traits, Allocator> &text, Delim &&delim) {
+  return split(std::basic_string_view<CharT, Traits>(text),
+               std::forward<Delim>(delim));
+}
+
+// The fields would point into a temporary.
+template <typename CharT, typename Traits, typename Allocator, typename Delim>
+void split(BasicString<CharT, Traits, Allocator> &&text, Delim &&delim) =
+    delete;
+
+template <typename CharT, typename Traits>
+constexpr SplitView<CharT, Traits, AnyOfDelimiter<CharT, Traits>, true>
+tokenize(std::basic_string_view<CharT, Traits> text,
+         std::type_identity_t<std::basic_string_view<CharT, Traits>> chars) {
+  return {text, AnyOfDelimiter<CharT, Traits>(chars)};
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+constexpr SplitView<CharT, Traits, AnyOfDelimiter<CharT, Traits>, true>
+tokenize(const BasicString<CharT, Traits, Allocator> &text,
+         std::type_identity_t<std::basic_string_view<CharT, Traits>> chars) {
+  return tokenize(std::basic_string_view<CharT, Traits>(text), chars);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+void tokenize(
+    BasicString<CharT, Traits, Allocator> &&text,
+    std::type_identity_t<std::basic_string_view<CharT, Traits>> chars) =
+    delete;
+
+#endif
@@ -0,0 +1,703 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <cerrno>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STRING_TABLE_MMAP 1
+#endif
+
+#include "BasicString.hpp"
+
+// Columnar storage for many strings. The characters of every string sit
+// back to back in one buffer, and string i is the range between offsets i
+// and i + 1, so a table of n strings costs its characters plus 8(n + 1)
+// bytes and two allocations, instead of a BasicString header and often an
+// allocation per string. Strings are read back as string_views into the
+// buffer, valid until the table next grows.
+//
+//   StringTable table;
+//   table.append(lines);             // one reservation for the whole range
+//   for (std::string_view s : table)
+//
+// DictionaryStringTable stores each distinct string once and a 32-bit code
+// per row. A table can be written to a flat file and mapped back with
+// MappedStringTable, which reads the strings straight out of the mapping.
+
+namespace string_table {
+
+using offset_type = uint64_t;
+
+// The file is this header, count + 1 offsets and chars_size characters, in
+// the byte order of the machine that wrote it.
+struct FileHeader {
+  static constexpr char expected_magic[8] = "STRTAB1";
+
+  char magic[8];
+  uint32_t char_size;
+  uint32_t offset_size;
+  uint64_t count;
+  uint64_t chars_size;
+};
+
+} // namespace string_table
+
+// Read-only view of a table: count + 1 offsets into a character buffer,
+// neither owned. Owning tables and mapped files hand these out.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class StringTableView {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using value_type = view_type;
+  using size_type = size_t;
+  using offset_type = string_table::offset_type;
+
+  // Random-access iterator yielding a view of each string.
+  class iterator {
+  public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = view_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = view_type;
+
+    iterator() = default;
+
+    view_type operator*() const noexcept {
+      return view_type(chars_ + offset_[0],
+                       static_cast<size_t>(offset_[1] - offset_[0]));
+    }
+    view_type operator[](difference_type n) const noexcept {
+      return *(*this + n);
+    }
+
+    iterator &operator++() noexcept {
+      ++offset_;
+      return *this;
+    }
+    iterator operator++(int) noexcept { return iterator(offset_++, chars_); }
+    iterator &operator--() noexcept {
+      --offset_;
+      return *this;
+    }
+    iterator operator--(int) noexcept { return iterator(offset_--, chars_); }
+    iterator &operator+=(difference_type n) noexcept {
+      offset_ += n;
+      return *this;
+    }
+    iterator &operator-=(difference_type n) noexcept {
+      offset_ -= n;
+      return *this;
+    }
+    friend iterator operator+(iterator it, difference_type n) noexcept {
+      return it += n;
+    }
+    friend iterator operator+(difference_type n, iterator it) noexcept {
+      return it += n;
+    }
+    friend iterator operator-(iterator it, difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const iterator &lhs,
+                                     const iterator &rhs) noexcept {
+      return lhs.offset_ - rhs.offset_;
+    }
+
+    bool operator==(const iterator &other) const noexcept {
+      return offset_ == other.offset_;
+    }
+    std::strong_ordering operator<=>(const iterator &other) const noexcept {
+      return offset_ <=> other.offset_;
+    }
+
+  private:
+    friend class StringTableView;
+
+    iterator(const offset_type *offset, const CharT *chars) noexcept
+        : offset_(offset), chars_(chars) {}
+
+    const offset_type *offset_ = nullptr;
+    const CharT *chars_ = nullptr;
+  };
+
+  using const_iterator = iterator;
+
+  StringTableView() noexcept = default;
+  StringTableView(const offset_type *offsets, size_type count,
+                  const CharT *chars) noexcept
+      : offsets_(offsets), count_(count), chars_(chars) {}
+
+  size_type size() const noexcept { return count_; }
+  bool empty() const noexcept { return count_ == 0; }
+  view_type operator[](size_type index) const noexcept;
+  view_type at(size_type index) const;
+  view_type front() const noexcept { return (*this)[0]; }
+  view_type back() const noexcept { return (*this)[count_ - 1]; }
+  iterator begin() const noexcept { return iterator(offsets_, chars_); }
+  iterator end() const noexcept { return iterator(offsets_ + count_, chars_); }
+
+  // All of the characters, and the count + 1 offsets into them.
+  view_type chars() const noexcept;
+  std::span<const offset_type> offsets() const noexcept;
+
+  // Writes the table in the layout MappedStringTable reads; throws
+  // std::system_error if the file cannot be written.
+  void write(std::ostream &out) const;
+  void write(const char *path) const;
+
+private:
+  static constexpr offset_type empty_offsets_[1] = {0};
+
+  const offset_type *offsets_ = empty_offsets_;
+  size_type count_ = 0;
+  const CharT *chars_ = nullptr;
+};
+
+template <typename CharT, typename Traits>
+inline typename StringTableView<CharT, Traits>::view_type
+StringTableView<CharT, Traits>::operator[](size_type index) const noexcept {
+  return view_type(chars_ + offsets_[index],
+                   static_cast<size_t>(offsets_[index + 1] - offsets_[index]));
+}
+
+template <typename CharT, typename Traits>
+inline typename StringTableView<CharT, Traits>::view_type
+StringTableView<CharT, Traits>::at(size_type index) const {
+  if (index >= count_) {
+    throw std::out_of_range("Position is out of range.");
+  }
+  return (*this)[index];
+}
+
+template <typename CharT, typename Traits>
+inline typename StringTableView<CharT, Traits>::view_type
+StringTableView<CharT, Traits>::chars() const noexcept {
+  return view_type(chars_, static_cast<size_t>(offsets_[count_]));
+}
+
+template <typename CharT, typename Traits>
+inline std::span<const typename StringTableView<CharT, Traits>::offset_type>
+StringTableView<CharT, Traits>::offsets() const noexcept {
+  return std::span<const offset_type>(offsets_, count_ + 1);
+}
+
+template <typename CharT, typename Traits>
+inline void StringTableView<CharT, Traits>::write(std::ostream &out) const {
+  string_table::FileHeader header{};
+  std::memcpy(header.magic, string_table::FileHeader::expected_magic,
+              sizeof(header.magic));
+  header.char_size = sizeof(CharT);
+  header.offset_size = sizeof(offset_type);
+  header.count = count_;
+  header.chars_size = offsets_[count_];
+
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(offsets_),
+            static_cast<std::streamsize>((count_ + 1) * sizeof(offset_type)));
+  out.write(reinterpret_cast<const char *>(chars_),
+            static_cast<std::streamsize>(header.chars_size * sizeof(CharT)));
+  if (!out) {
+    throw std::system_error(std::make_error_code(std::errc::io_error),
+                            "StringTable: write failed");
+  }
+}
+
+template <typename CharT, typename Traits>
+inline void StringTableView<CharT, Traits>::write(const char *path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::string("StringTable: cannot open ") + path);
+  }
+  write(out);
+  out.close();
+  if (!out) {
+    throw std::system_error(std::make_error_code(std::errc::io_error),
+                            "StringTable: write failed");
+  }
+}
+
+// Growable table owning its buffers. Appending copies the characters to
+// the end of the buffer; both buffers grow geometrically.
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+class BasicStringTable {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using table_view = StringTableView<CharT, Traits>;
+  using value_type = view_type;
+  using size_type = size_t;
+  using offset_type = string_table::offset_type;
+  using allocator_type = Allocator;
+  using iterator = typename table_view::iterator;
+  using const_iterator = iterator;
+
+  BasicStringTable();
+  explicit BasicStringTable(const Allocator &alloc);
+
+  Allocator get_allocator() const;
+
+  size_type size() const noexcept { return offsets_.size() - 1; }
+  bool empty() const noexcept { return offsets_.size() == 1; }
+  view_type operator[](size_type index) const noexcept;
+  view_type at(size_type index) const;
+  iterator begin() const noexcept { return view().begin(); }
+  iterator end() const noexcept { return view().end(); }
+  table_view view() const noexcept;
+  operator table_view() const noexcept { return view(); }
+
+  view_type chars() const noexcept { return view_type(chars_); }
+  std::span<const offset_type> offsets() const noexcept { return offsets_; }
+
+  // Room for strings more strings holding chars more characters in total.
+  void reserve(size_type strings, size_type chars);
+  void shrink_to_fit();
+  void clear() noexcept;
+
+  // Adds one string and returns its index.
+  size_type push_back(view_type str);
+  // Adds every string of a range of things that convert to view_type. A
+  // sized forward range is measured first, so each buffer grows once.
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>,
+                                 view_type>
+  void append(R &&strings);
+
+  void write(std::ostream &out) const { view().write(out); }
+  void write(const char *path) const { view().write(path); }
+
+private:
+  using offset_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<offset_type>;
+
+  BasicString<CharT, Traits, Allocator> chars_;
+  std::vector<offset_type, offset_allocator> offsets_;
+};
+
+using StringTable = BasicStringTable<char>;
+
+template <typename CharT, typename Traits, typename Allocator>
+inline BasicStringTable<CharT, Traits, Allocator>::BasicStringTable()
+    : BasicStringTable(Allocator()) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline BasicStringTable<CharT, Traits, Allocator>::BasicStringTable(
+    const Allocator &alloc)
+    : chars_(alloc), offsets_(1, offset_type(0), offset_allocator(alloc)) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline Allocator
+BasicStringTable<CharT, Traits, Allocator>::get_allocator() const {
+  return chars_.get_allocator();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicStringTable<CharT, Traits, Allocator>::view_type
+BasicStringTable<CharT, Traits, Allocator>::operator[](
+    size_type index) const noexcept {
+  return view()[index];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicStringTable<CharT, Traits, Allocator>::view_type
+BasicStringTable<CharT, Traits, Allocator>::at(size_type index) const {
+  return view().at(index);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicStringTable<CharT, Traits, Allocator>::table_view
+BasicStringTable<CharT, Traits, Allocator>::view() const noexcept {
+  return table_view(offsets_.data(), size(), chars_.data());
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void BasicStringTable<CharT, Traits, Allocator>::reserve(
+    size_type strings, size_type chars) {
+  offsets_.reserve(offsets_.size() + strings);
+  chars_.reserve(chars_.size() + chars);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void BasicStringTable<CharT, Traits, Allocator>::shrink_to_fit() {
+  offsets_.shrink_to_fit();
+  chars_.shrink_to_fit();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void BasicStringTable<CharT, Traits, Allocator>::clear() noexcept {
+  offsets_.resize(1);
+  chars_.clear();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicStringTable<CharT, Traits, Allocator>::size_type
+BasicStringTable<CharT, Traits, Allocator>::push_back(view_type str) {
+  chars_.append(str);
+  offsets_.push_back(chars_.size());
+  return offsets_.size() - 2;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <std::ranges::input_range R>
+  requires std::convertible_to<std::ranges::range_reference_t<R>,
+                               std::basic_string_view<CharT, Traits>>
+inline void BasicStringTable<CharT, Traits, Allocator>::append(R &&strings) {
+  if constexpr (std::ranges::sized_range<R> &&
+                std::ranges::forward_range<R>) {
+    size_type chars = 0;
+    for (auto &&str : strings)
+      chars += view_type(str).size();
+    reserve(std::ranges::size(strings), chars);
+  }
+  for (auto &&str : strings) {
+    chars_.append(view_type(str));
+    offsets_.push_back(chars_.size());
+  }
+}
+
+// Rows that repeat a string share one copy of it. Each row holds the code
+// of its string, the string's index in dictionary(); codes are handed out
+// in order of first appearance. An open-addressing index from strings to
+// codes, kept at most half full, finds repeats.
+template <typename CharT, typename Traits = std::char_traits<CharT>,
+          typename Allocator = std::allocator<CharT>>
+class BasicDictionaryStringTable {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using table_type = BasicStringTable<CharT, Traits, Allocator>;
+  using size_type = size_t;
+  using code_type = uint32_t;
+  using allocator_type = Allocator;
+
+  static constexpr code_type npos = static_cast<code_type>(-1);
+
+  BasicDictionaryStringTable();
+  explicit BasicDictionaryStringTable(const Allocator &alloc);
+
+  // Number of rows.
+  size_type size() const noexcept { return codes_.size(); }
+  bool empty() const noexcept { return codes_.empty(); }
+  view_type operator[](size_type row) const noexcept;
+  view_type at(size_type row) const;
+  code_type code(size_type row) const noexcept { return codes_[row]; }
+  std::span<const code_type> codes() const noexcept { return codes_; }
+  // The distinct strings, indexed by code.
+  const table_type &dictionary() const noexcept { return dictionary_; }
+
+  // Code of str, or npos if no row holds it.
+  code_type find(view_type str) const noexcept;
+
+  void reserve(size_type rows);
+  void clear() noexcept;
+
+  // Adds a row holding str and returns its code.
+  code_type push_back(view_type str);
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>,
+                                 view_type>
+  void append(R &&strings);
+
+private:
+  struct Slot {
+    size_t hash;
+    code_type code;
+  };
+
+  using code_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<code_type>;
+  using slot_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+  static constexpr size_t initial_capacity = 64;
+
+  static size_t hash_of(view_type str) noexcept;
+  size_t probe(view_type str, size_t hash) const noexcept;
+  void grow();
+
+  table_type dictionary_;
+  std::vector<code_type, code_allocator> codes_;
+  std::vector<Slot, slot_allocator> slots_;
+};
+
+using DictionaryStringTable = BasicDictionaryStringTable<char>;
+
+template <typename CharT, typename Traits, typename Allocator>
+inline BasicDictionaryStringTable<CharT, Traits,
+                                  Allocator>::BasicDictionaryStringTable()
+    : BasicDictionaryStringTable(Allocator()) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline BasicDictionaryStringTable<CharT, Traits, Allocator>::
+    BasicDictionaryStringTable(const Allocator &alloc)
+    : dictionary_(alloc), codes_(code_allocator(alloc)),
+      slots_(slot_allocator(alloc)) {}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicDictionaryStringTable<CharT, Traits, Allocator>::view_type
+BasicDictionaryStringTable<CharT, Traits, Allocator>::operator[](
+    size_type row) const noexcept {
+  return dictionary_[codes_[row]];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicDictionaryStringTable<CharT, Traits, Allocator>::view_type
+BasicDictionaryStringTable<CharT, Traits, Allocator>::at(size_type row) const {
+  if (row >= codes_.size()) {
+    throw std::out_of_range("Position is out of range.");
+  }
+  return (*this)[row];
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline size_t BasicDictionaryStringTable<CharT, Traits, Allocator>::hash_of(
+    view_type str) noexcept {
+  return BasicStringHash<CharT, Traits>()(str);
+}
+
+// Index of the slot holding str, or of the empty slot where it would go.
+template <typename CharT, typename Traits, typename Allocator>
+inline size_t BasicDictionaryStringTable<CharT, Traits, Allocator>::probe(
+    view_type str, size_t hash) const noexcept {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    const Slot &slot = slots_[i];
+    if (slot.code == npos ||
+        (slot.hash == hash && dictionary_[slot.code] == str))
+      return i;
+  }
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void BasicDictionaryStringTable<CharT, Traits, Allocator>::grow() {
+  size_t capacity = slots_.empty() ? initial_capacity : slots_.size() * 2;
+  std::vector<Slot, slot_allocator> old = std::move(slots_);
+  slots_.assign(capacity, Slot{0, npos});
+
+  size_t mask = capacity - 1;
+  for (const Slot &slot : old) {
+    if (slot.code == npos)
+      continue;
+    size_t i = slot.hash & mask;
+    while (slots_[i].code != npos)
+      i = (i + 1) & mask;
+    slots_[i] = slot;
+  }
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicDictionaryStringTable<CharT, Traits, Allocator>::code_type
+BasicDictionaryStringTable<CharT, Traits, Allocator>::find(
+    view_type str) const noexcept {
+  if (slots_.empty())
+    return npos;
+  return slots_[probe(str, hash_of(str))].code;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void
+BasicDictionaryStringTable<CharT, Traits, Allocator>::reserve(size_type rows) {
+  codes_.reserve(codes_.size() + rows);
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline void
+BasicDictionaryStringTable<CharT, Traits, Allocator>::clear() noexcept {
+  dictionary_.clear();
+  codes_.clear();
+  slots_.clear();
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+inline typename BasicDictionaryStringTable<CharT, Traits, Allocator>::code_type
+BasicDictionaryStringTable<CharT, Traits, Allocator>::push_back(
+    view_type str) {
+  if ((dictionary_.size() + 1) * 2 > slots_.size())
+    grow();
+
+  size_t hash = hash_of(str);
+  Slot &slot = slots_[probe(str, hash)];
+  if (slot.code == npos) {
+    if (dictionary_.size() >= npos) {
+      throw std::length_error(
+          "DictionaryStringTable: too many distinct strings");
+    }
+    slot = Slot{hash, static_cast<code_type>(dictionary_.push_back(str))};
+  }
+  codes_.push_back(slot.code);
+  return slot.code;
+}
+
+template <typename CharT, typename Traits, typename Allocator>
+template <std::ranges::input_range R>
+  requires std::convertible_to<std::ranges::range_reference_t<R>,
+                               std::basic_string_view<CharT, Traits>>
+inline void
+BasicDictionaryStringTable<CharT, Traits, Allocator>::append(R &&strings) {
+  if constexpr (std::ranges::sized_range<R>)
+    reserve(std::ranges::size(strings));
+  for (auto &&str : strings)
+    push_back(view_type(str));
+}
+
+#ifdef STRING_TABLE_MMAP
+
+// A table file mapped read-only into memory. The strings are views into
+// the mapping, so opening costs the same for any table size and pages are
+// read as they are touched. The header and the file length are checked;
+// the offsets are trusted.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class BasicMappedStringTable {
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using table_view = StringTableView<CharT, Traits>;
+  using size_type = size_t;
+  using iterator = typename table_view::iterator;
+  using const_iterator = iterator;
+
+  // Throws std::system_error if the file cannot be opened or mapped, and
+  // std::runtime_error if it is not a table of CharT.
+  explicit BasicMappedStringTable(const char *path);
+  BasicMappedStringTable(BasicMappedStringTable &&other) noexcept;
+  BasicMappedStringTable &operator=(BasicMappedStringTable &&other) noexcept;
+  ~BasicMappedStringTable();
+
+  size_type size() const noexcept { return view_.size(); }
+  bool empty() const noexcept { return view_.empty(); }
+  view_type operator[](size_type index) const noexcept {
+    return view_[index];
+  }
+  view_type at(size_type index) const { return view_.at(index); }
+  iterator begin() const noexcept { return view_.begin(); }
+  iterator end() const noexcept { return view_.end(); }
+  table_view view() const noexcept { return view_; }
+  operator table_view() const noexcept { return view_; }
+
+private:
+  void unmap() noexcept;
+
+  void *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  table_view view_;
+};
+
+using MappedStringTable = BasicMappedStringTable<char>;
+
+template <typename CharT, typename Traits>
+inline BasicMappedStringTable<CharT, Traits>::BasicMappedStringTable(
+    const char *path) {
+  using string_table::FileHeader;
+  using offset_type = string_table::offset_type;
+
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::string("StringTable: cannot open ") + path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(),
+                            std::string("StringTable: cannot stat ") + path);
+  }
+  size_t file_size = static_cast<size_t>(info.st_size);
+  if (file_size < sizeof(FileHeader)) {
+    ::close(fd);
+    throw std::runtime_error("StringTable: not a string table file");
+  }
+
+  void *mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int error = errno;
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::system_error(error, std::generic_category(),
+                            std::string("StringTable: cannot map ") + path);
+  }
+  mapping_ = mapping;
+  mapping_size_ = file_size;
+
+  const auto *base = static_cast<const unsigned char *>(mapping);
+  FileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  size_t offsets_bytes = 0;
+  bool valid =
+      std::memcmp(header.magic, FileHeader::expected_magic,
+                  sizeof(header.magic)) == 0 &&
+      header.char_size == sizeof(CharT) &&
+      header.offset_size == sizeof(offset_type) &&
+      header.count < file_size / sizeof(offset_type);
+  if (valid) {
+    offsets_bytes = (header.count + 1) * sizeof(offset_type);
+    valid = header.chars_size <= file_size / sizeof(CharT) &&
+            sizeof(header) + offsets_bytes +
+                    header.chars_size * sizeof(CharT) ==
+                file_size;
+  }
+  const auto *offsets =
+      reinterpret_cast<const offset_type *>(base + sizeof(header));
+  if (!valid || offsets[0] != 0 || offsets[header.count] != header.chars_size) {
+    unmap();
+    throw std::runtime_error("StringTable: not a string table file");
+  }
+
+  view_ = table_view(
+      offsets, header.count,
+      reinterpret_cast<const CharT *>(base + sizeof(header) + offsets_bytes));
+}
+
+template <typename CharT, typename Traits>
+inline BasicMappedStringTable<CharT, Traits>::BasicMappedStringTable(
+    BasicMappedStringTable &&other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)),
+      view_(std::exchange(other.view_, table_view())) {}
+
+template <typename CharT, typename Traits>
+inline BasicMappedStringTable<CharT, Traits> &
+BasicMappedStringTable<CharT, Traits>::operator=(
+    BasicMappedStringTable &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    view_ = std::exchange(other.view_, table_view());
+  }
+  return *this;
+}
+
+template <typename CharT, typename Traits>
+inline BasicMappedStringTable<CharT, Traits>::~BasicMappedStringTable() {
+  unmap();
+}
+
+template <typename CharT, typename Traits>
+inline void BasicMappedStringTable<CharT, Traits>::unmap() noexcept {
+  if (mapping_ != nullptr)
+    ::munmap(mapping_, mapping_size_);
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  view_ = table_view();
+}
+
+#endif
+
+#endif
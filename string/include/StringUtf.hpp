@@ -0,0 +1,592 @@
+#ifndef STRING_UTF_H
+#define STRING_UTF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(STRING_NO_SIMD) && defined(__GNUC__) &&                           \
+    (defined(__x86_64__) || defined(__i386__))
+#define STRING_UTF_X86 1
+#include <immintrin.h>
+#endif
+
+// UTF-8 validation and UTF-8 <-> UTF-16/UTF-32 transcoding kernels behind
+// Transcode.hpp. UTF-16 and UTF-32 code units are any 2- and 4-byte
+// character type (char16_t, char32_t, or wchar_t of that size).
+//
+// Validation runs the Keiser-Lemire lookup algorithm 32 bytes at a time
+// when AVX2 is available (picked at runtime) and otherwise skips ASCII 16
+// bytes at a time with SSE2 and checks the rest one sequence at a time.
+// The transcoders expect input that has already been validated; they widen
+// or narrow runs of ASCII 16 bytes at a time and handle everything else
+// with the scalar codec. The *_length_from_* helpers give the exact output
+// size, so callers can size the destination once.
+namespace string_utf {
+
+// Scalar codec ---------------------------------------------------------------
+
+// Length of the valid UTF-8 sequence at s[0..n), or 0 if it is malformed,
+// overlong, a surrogate, above U+10FFFF or cut off.
+inline size_t utf8_sequence_length(const unsigned char *s, size_t n) {
+  unsigned char c = s[0];
+  if (c < 0x80)
+    return 1;
+
+  size_t len;
+  uint32_t cp;
+  if (c >= 0xC2 && c <= 0xDF) {
+    len = 2;
+    cp = c & 0x1F;
+  } else if ((c & 0xF0) == 0xE0) {
+    len = 3;
+    cp = c & 0x0F;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    len = 4;
+    cp = c & 0x07;
+  } else {
+    return 0;
+  }
+  if (n < len)
+    return 0;
+
+  for (size_t k = 1; k < len; ++k) {
+    if ((s[k] & 0xC0) != 0x80)
+      return 0;
+    cp = (cp << 6) | (s[k] & 0x3F);
+  }
+
+  if ((len == 3 && cp < 0x800) || (len == 4 && cp < 0x10000) ||
+      (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+    return 0;
+  return len;
+}
+
+// Decodes the valid sequence at *s and advances past it.
+inline uint32_t decode_utf8(const unsigned char *&s) {
+  unsigned char c = *s++;
+  if (c < 0x80)
+    return c;
+  if (c < 0xE0) {
+    uint32_t cp = ((c & 0x1Fu) << 6) | (s[0] & 0x3Fu);
+    s += 1;
+    return cp;
+  }
+  if (c < 0xF0) {
+    uint32_t cp =
+        ((c & 0x0Fu) << 12) | ((s[0] & 0x3Fu) << 6) | (s[1] & 0x3Fu);
+    s += 2;
+    return cp;
+  }
+  uint32_t cp = ((c & 0x07u) << 18) | ((s[0] & 0x3Fu) << 12) |
+                ((s[1] & 0x3Fu) << 6) | (s[2] & 0x3Fu);
+  s += 3;
+  return cp;
+}
+
+inline char *encode_utf8(uint32_t cp, char *out) {
+  if (cp < 0x80) {
+    *out++ = static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    *out++ = static_cast<char>(0xC0 | (cp >> 6));
+    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    *out++ = static_cast<char>(0xE0 | (cp >> 12));
+    *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    *out++ = static_cast<char>(0xF0 | (cp >> 18));
+    *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+template <typename Unit> inline Unit *encode_utf16(uint32_t cp, Unit *out) {
+  if (cp < 0x10000) {
+    *out++ = static_cast<Unit>(cp);
+  } else {
+    cp -= 0x10000;
+    *out++ = static_cast<Unit>(0xD800 + (cp >> 10));
+    *out++ = static_cast<Unit>(0xDC00 + (cp & 0x3FF));
+  }
+  return out;
+}
+
+inline bool validate_utf8_scalar(const char *str, size_t n, size_t i = 0) {
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(str);
+  while (i < n) {
+    if (i + 8 <= n) {
+      uint64_t word;
+      std::memcpy(&word, s + i, sizeof(word));
+      if ((word & 0x8080808080808080ull) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+    size_t len = utf8_sequence_length(s + i, n - i);
+    if (len == 0)
+      return false;
+    i += len;
+  }
+  return true;
+}
+
+// Vectorized validation ------------------------------------------------------
+
+#ifdef STRING_UTF_X86
+
+inline bool validate_utf8_sse2(const char *str, size_t n) {
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(str);
+  size_t i = 0;
+  while (i + 16 <= n) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    if (_mm_movemask_epi8(block) == 0) {
+      i += 16;
+      continue;
+    }
+    // Check whole sequences until the block is behind us; i then sits on a
+    // sequence boundary again.
+    size_t end = i + 16;
+    while (i < end) {
+      size_t len = utf8_sequence_length(s + i, n - i);
+      if (len == 0)
+        return false;
+      i += len;
+    }
+  }
+  return validate_utf8_scalar(str, n, i);
+}
+
+// Error bits of the lookup tables: every malformed two-byte window sets at
+// least one bit in all three lookups, and the byte after a 3- or 4-byte
+// lead is checked against the expected continuation count separately.
+namespace utf8_error {
+inline constexpr uint8_t too_short = 1 << 0;
+inline constexpr uint8_t too_long = 1 << 1;
+inline constexpr uint8_t overlong_3 = 1 << 2;
+inline constexpr uint8_t too_large = 1 << 3;
+inline constexpr uint8_t surrogate = 1 << 4;
+inline constexpr uint8_t overlong_2 = 1 << 5;
+inline constexpr uint8_t too_large_1000 = 1 << 6;
+inline constexpr uint8_t overlong_4 = 1 << 6;
+inline constexpr uint8_t two_conts = 1 << 7;
+inline constexpr uint8_t carry = too_short | too_long | two_conts;
+} // namespace utf8_error
+
+__attribute__((target("avx2"))) inline __m256i
+utf8_prev(__m256i input, __m256i prev_input, int n) {
+  __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+  switch (n) {
+  case 1:
+    return _mm256_alignr_epi8(input, shifted, 15);
+  case 2:
+    return _mm256_alignr_epi8(input, shifted, 14);
+  default:
+    return _mm256_alignr_epi8(input, shifted, 13);
+  }
+}
+
+__attribute__((target("avx2"))) inline __m256i utf8_high_nibble(__m256i v) {
+  return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+__attribute__((target("avx2"))) inline __m256i
+utf8_table(const uint8_t (&entries)[16]) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(entries)));
+}
+
+// Errors in the 32 bytes of input, given the 32 bytes before them.
+__attribute__((target("avx2"))) inline __m256i
+utf8_block_errors(__m256i input, __m256i prev_input) {
+  using namespace utf8_error;
+  // The tables are indexed by a nibble, the same 16 entries in both lanes.
+  static constexpr uint8_t byte_1_high_entries[16] = {
+      too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+      too_long, two_conts, two_conts, two_conts, two_conts,
+      too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+      too_short | too_large | too_large_1000 | overlong_4};
+  static constexpr uint8_t byte_1_low_entries[16] = {
+      carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry,
+      carry, carry | too_large, carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000 | surrogate,
+      carry | too_large | too_large_1000, carry | too_large | too_large_1000};
+  constexpr uint8_t conts_1000 = too_long | overlong_2 | two_conts |
+                                 overlong_3 | too_large_1000 | overlong_4;
+  constexpr uint8_t conts_1001 =
+      too_long | overlong_2 | two_conts | overlong_3 | too_large;
+  constexpr uint8_t conts_101 =
+      too_long | overlong_2 | two_conts | surrogate | too_large;
+  static constexpr uint8_t byte_2_high_entries[16] = {
+      too_short, too_short, too_short, too_short, too_short, too_short,
+      too_short, too_short, conts_1000, conts_1001, conts_101, conts_101,
+      too_short, too_short, too_short, too_short};
+  const __m256i byte_1_high_table = utf8_table(byte_1_high_entries);
+  const __m256i byte_1_low_table = utf8_table(byte_1_low_entries);
+  const __m256i byte_2_high_table = utf8_table(byte_2_high_entries);
+
+  __m256i prev1 = utf8_prev(input, prev_input, 1);
+  __m256i byte_1_high =
+      _mm256_shuffle_epi8(byte_1_high_table, utf8_high_nibble(prev1));
+  __m256i byte_1_low = _mm256_shuffle_epi8(
+      byte_1_low_table, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+  __m256i byte_2_high =
+      _mm256_shuffle_epi8(byte_2_high_table, utf8_high_nibble(input));
+  __m256i special_cases =
+      _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // Bytes two or three places after a 3- or 4-byte lead must be
+  // continuations; the tables flag exactly those as two_conts.
+  __m256i prev2 = utf8_prev(input, prev_input, 2);
+  __m256i prev3 = utf8_prev(input, prev_input, 3);
+  __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+  __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+  __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                    _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must23, special_cases);
+}
+
+// Non-zero where the block ends inside a sequence that the next block has
+// to finish.
+__attribute__((target("avx2"))) inline __m256i
+utf8_incomplete(__m256i input) {
+  const __m256i max_value = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1),
+      static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+  return _mm256_subs_epu8(input, max_value);
+}
+
+// Carries the state from one 32-byte block to the next.
+struct utf8_avx2_state {
+  __m256i error;
+  __m256i prev_input;
+  __m256i prev_incomplete;
+};
+
+__attribute__((target("avx2"))) inline void
+utf8_validate_block(utf8_avx2_state &state, __m256i input) {
+  if (_mm256_movemask_epi8(input) == 0) {
+    state.error = _mm256_or_si256(state.error, state.prev_incomplete);
+    state.prev_incomplete = _mm256_setzero_si256();
+  } else {
+    state.error = _mm256_or_si256(
+        state.error, utf8_block_errors(input, state.prev_input));
+    state.prev_incomplete = utf8_incomplete(input);
+  }
+  state.prev_input = input;
+}
+
+__attribute__((target("avx2"))) inline bool
+validate_utf8_avx2(const char *str, size_t n) {
+  utf8_avx2_state state = {_mm256_setzero_si256(), _mm256_setzero_si256(),
+                           _mm256_setzero_si256()};
+
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+    utf8_validate_block(
+        state, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i)));
+
+  // The tail is padded with NULs, which are ASCII: a sequence cut off by
+  // the end of input shows up as too_short, and the all-ASCII final block
+  // flushes any sequence left open by a full last block.
+  // An empty input may come with a null pointer, so nothing is copied then.
+  alignas(32) char tail[32] = {};
+  if (n - i != 0)
+    std::memcpy(tail, str + i, n - i);
+  utf8_validate_block(
+      state, _mm256_load_si256(reinterpret_cast<const __m256i *>(tail)));
+  if (n - i != 0)
+    utf8_validate_block(state, _mm256_setzero_si256());
+
+  return _mm256_testz_si256(state.error, state.error) != 0;
+}
+
+#endif
+
+using validate_kernel = bool (*)(const char *, size_t);
+
+inline bool validate_utf8_portable(const char *str, size_t n) {
+  return validate_utf8_scalar(str, n);
+}
+
+inline validate_kernel select_validate_kernel() {
+#ifdef STRING_UTF_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return validate_utf8_avx2;
+  return validate_utf8_sse2;
+#else
+  return validate_utf8_portable;
+#endif
+}
+
+inline bool validate_utf8(const char *str, size_t n) {
+  static const validate_kernel kernel = select_validate_kernel();
+  return kernel(str, n);
+}
+
+// Validation of the wide encodings is a single pass per code unit.
+template <typename Unit>
+inline bool validate_utf16(const Unit *str, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t u = static_cast<uint16_t>(str[i]);
+    if (u < 0xD800 || u > 0xDFFF)
+      continue;
+    if (u > 0xDBFF || i + 1 == n)
+      return false;
+    uint32_t next = static_cast<uint16_t>(str[++i]);
+    if (next < 0xDC00 || next > 0xDFFF)
+      return false;
+  }
+  return true;
+}
+
+template <typename Unit>
+inline bool validate_utf32(const Unit *str, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t cp = static_cast<uint32_t>(str[i]);
+    if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+      return false;
+  }
+  return true;
+}
+
+// Output sizes ---------------------------------------------------------------
+
+// Every byte that is not a continuation starts a code point; 4-byte leads
+// need a surrogate pair in UTF-16.
+inline size_t utf8_code_points(const char *str, size_t n,
+                               size_t *four_byte = nullptr) {
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(str);
+  size_t leads = 0;
+  size_t fours = 0;
+  size_t i = 0;
+#ifdef STRING_UTF_X86
+  const __m128i last_cont = _mm_set1_epi8(static_cast<char>(0xBF));
+  const __m128i first_four = _mm_set1_epi8(static_cast<char>(0xF0));
+  const __m128i zero = _mm_setzero_si128();
+  while (i + 16 <= n) {
+    // Per-byte counters, folded into the totals before they can overflow.
+    __m128i lead_count = zero;
+    __m128i four_count = zero;
+    for (int k = 0; k < 255 && i + 16 <= n; ++k, i += 16) {
+      __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+      // Signed compare: continuations 0x80..0xBF are the bytes <= -65.
+      lead_count =
+          _mm_sub_epi8(lead_count, _mm_cmpgt_epi8(block, last_cont));
+      four_count = _mm_sub_epi8(
+          four_count,
+          _mm_cmpeq_epi8(_mm_max_epu8(block, first_four), block));
+    }
+    __m128i leads_sum = _mm_sad_epu8(lead_count, zero);
+    __m128i fours_sum = _mm_sad_epu8(four_count, zero);
+    leads += static_cast<size_t>(_mm_cvtsi128_si32(leads_sum)) +
+             static_cast<size_t>(_mm_extract_epi16(leads_sum, 4));
+    fours += static_cast<size_t>(_mm_cvtsi128_si32(fours_sum)) +
+             static_cast<size_t>(_mm_extract_epi16(fours_sum, 4));
+  }
+#endif
+  for (; i < n; ++i) {
+    leads += (s[i] & 0xC0) != 0x80;
+    fours += s[i] >= 0xF0;
+  }
+  if (four_byte != nullptr)
+    *four_byte = fours;
+  return leads;
+}
+
+inline size_t utf16_length_from_utf8(const char *str, size_t n) {
+  size_t fours;
+  size_t points = utf8_code_points(str, n, &fours);
+  return points + fours;
+}
+
+inline size_t utf32_length_from_utf8(const char *str, size_t n) {
+  return utf8_code_points(str, n);
+}
+
+template <typename Unit>
+inline size_t utf8_length_from_utf16(const Unit *str, size_t n) {
+  size_t len = 0;
+  size_t i = 0;
+#ifdef STRING_UTF_X86
+  if constexpr (sizeof(Unit) == 2) {
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i above_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i above_two = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogates = _mm_set1_epi16(static_cast<short>(0xD800));
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 8 <= n) {
+      // 32-bit lane totals, folded in before they can overflow.
+      __m128i total = zero;
+      for (int k = 0; k < 65536 && i + 8 <= n; ++k, i += 8) {
+        __m128i units =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+        __m128i ascii =
+            _mm_cmpeq_epi16(_mm_and_si128(units, above_ascii), zero);
+        __m128i top = _mm_and_si128(units, above_two);
+        __m128i two = _mm_or_si128(_mm_cmpeq_epi16(top, zero),
+                                   _mm_cmpeq_epi16(top, surrogates));
+        // 3 bytes, minus one for each mask that holds.
+        __m128i bytes =
+            _mm_add_epi16(_mm_add_epi16(_mm_set1_epi16(3), ascii), two);
+        total = _mm_add_epi32(total, _mm_madd_epi16(bytes, ones));
+      }
+      alignas(16) uint32_t lanes[4];
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes), total);
+      len += static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    uint32_t u = static_cast<uint16_t>(str[i]);
+    // A surrogate pair is four bytes, two per unit.
+    len += u < 0x80 ? 1 : (u < 0x800 || (u >= 0xD800 && u <= 0xDFFF)) ? 2 : 3;
+  }
+  return len;
+}
+
+template <typename Unit>
+inline size_t utf8_length_from_utf32(const Unit *str, size_t n) {
+  size_t len = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t cp = static_cast<uint32_t>(str[i]);
+    len += cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+  }
+  return len;
+}
+
+// Transcoders ----------------------------------------------------------------
+//
+// Each returns the end of the output. The input must be valid.
+
+template <typename Unit>
+inline Unit *utf8_to_utf16(const char *str, size_t n, Unit *out) {
+  static_assert(sizeof(Unit) == 2, "UTF-16 needs a 2-byte code unit");
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(str);
+  const unsigned char *end = s + n;
+#ifdef STRING_UTF_X86
+  while (end - s >= 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    if (_mm_movemask_epi8(block) == 0) {
+      __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                       _mm_unpacklo_epi8(block, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8),
+                       _mm_unpackhi_epi8(block, zero));
+      s += 16;
+      out += 16;
+      continue;
+    }
+    const unsigned char *block_end = s + 16;
+    while (s < block_end)
+      out = encode_utf16(decode_utf8(s), out);
+  }
+#endif
+  while (s < end)
+    out = encode_utf16(decode_utf8(s), out);
+  return out;
+}
+
+template <typename Unit>
+inline Unit *utf8_to_utf32(const char *str, size_t n, Unit *out) {
+  static_assert(sizeof(Unit) == 4, "UTF-32 needs a 4-byte code unit");
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(str);
+  const unsigned char *end = s + n;
+#ifdef STRING_UTF_X86
+  while (end - s >= 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    if (_mm_movemask_epi8(block) == 0) {
+      __m128i zero = _mm_setzero_si128();
+      __m128i lo = _mm_unpacklo_epi8(block, zero);
+      __m128i hi = _mm_unpackhi_epi8(block, zero);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                       _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4),
+                       _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8),
+                       _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 12),
+                       _mm_unpackhi_epi16(hi, zero));
+      s += 16;
+      out += 16;
+      continue;
+    }
+    const unsigned char *block_end = s + 16;
+    while (s < block_end)
+      *out++ = static_cast<Unit>(decode_utf8(s));
+  }
+#endif
+  while (s < end)
+    *out++ = static_cast<Unit>(decode_utf8(s));
+  return out;
+}
+
+template <typename Unit>
+inline char *utf16_to_utf8(const Unit *str, size_t n, char *out) {
+  static_assert(sizeof(Unit) == 2, "UTF-16 needs a 2-byte code unit");
+  size_t i = 0;
+  while (i < n) {
+#ifdef STRING_UTF_X86
+    if (i + 8 <= n) {
+      __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+      __m128i high = _mm_and_si128(block, _mm_set1_epi16(
+                                              static_cast<short>(0xFF80)));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) ==
+          0xFFFF) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out),
+                         _mm_packus_epi16(block, block));
+        i += 8;
+        out += 8;
+        continue;
+      }
+    }
+#endif
+    uint32_t u = static_cast<uint16_t>(str[i++]);
+    if (u >= 0xD800 && u <= 0xDBFF) {
+      uint32_t low = static_cast<uint16_t>(str[i++]);
+      u = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+    }
+    out = encode_utf8(u, out);
+  }
+  return out;
+}
+
+template <typename Unit>
+inline char *utf32_to_utf8(const Unit *str, size_t n, char *out) {
+  static_assert(sizeof(Unit) == 4, "UTF-32 needs a 4-byte code unit");
+  size_t i = 0;
+  while (i < n) {
+#ifdef STRING_UTF_X86
+    if (i + 4 <= n) {
+      __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+      __m128i high = _mm_and_si128(block, _mm_set1_epi32(~0x7F));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) ==
+          0xFFFF) {
+        __m128i words = _mm_packs_epi32(block, block);
+        int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+        std::memcpy(out, &bytes, 4);
+        i += 4;
+        out += 4;
+        continue;
+      }
+    }
+#endif
+    out = encode_utf8(static_cast<uint32_t>(str[i++]), out);
+  }
+  return out;
+}
+
+} // namespace string_utf
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include "BasicString.hpp"
+#include "StringUtf.hpp"
+
+// Conversions between UTF-8 in char strings and UTF-16/UTF-32 in char16_t,
+// char32_t and wchar_t strings. Each one validates the input, works out the
+// exact output length, and writes the result straight into a BasicString of
+// that size through resize_and_overwrite, so there is a single allocation
+// and no intermediate buffer. Invalid input throws std::range_error, the
+// way std::wstring_convert reports it.
+
+inline bool is_valid_utf8(std::string_view str) {
+  return string_utf::validate_utf8(str.data(), str.size());
+}
+
+namespace string_utf {
+
+// Checks utf8 and fills a StringT with its UTF-16 or UTF-32 form, depending
+// on the size of the character type.
+template <typename StringT>
+inline StringT widen(std::string_view utf8,
+                     const typename StringT::allocator_type &alloc) {
+  using unit = typename StringT::value_type;
+  if (!validate_utf8(utf8.data(), utf8.size()))
+    throw std::range_error("Invalid UTF-8 sequence.");
+
+  StringT out(alloc);
+  if constexpr (sizeof(unit) == 2) {
+    out.resize_and_overwrite(
+        utf16_length_from_utf8(utf8.data(), utf8.size()),
+        [&](unit *data, size_t n) {
+          utf8_to_utf16(utf8.data(), utf8.size(), data);
+          return n;
+        });
+  } else {
+    out.resize_and_overwrite(
+        utf32_length_from_utf8(utf8.data(), utf8.size()),
+        [&](unit *data, size_t n) {
+          utf8_to_utf32(utf8.data(), utf8.size(), data);
+          return n;
+        });
+  }
+  return out;
+}
+
+template <typename StringT, typename Unit>
+inline StringT narrow(std::basic_string_view<Unit> wide,
+                      const typename StringT::allocator_type &alloc) {
+  static_assert(sizeof(Unit) == 2 || sizeof(Unit) == 4,
+                "Code units must be 16 or 32 bits wide.");
+  StringT out(alloc);
+  if constexpr (sizeof(Unit) == 2) {
+    if (!validate_utf16(wide.data(), wide.size()))
+      throw std::range_error("Invalid UTF-16 sequence.");
+    out.resize_and_overwrite(
+        utf8_length_from_utf16(wide.data(), wide.size()),
+        [&](char *data, size_t n) {
+          utf16_to_utf8(wide.data(), wide.size(), data);
+          return n;
+        });
+  } else {
+    if (!validate_utf32(wide.data(), wide.size()))
+      throw std::range_error("Invalid UTF-32 code point.");
+    out.resize_and_overwrite(
+        utf8_length_from_utf32(wide.data(), wide.size()),
+        [&](char *data, size_t n) {
+          utf32_to_utf8(wide.data(), wide.size(), data);
+          return n;
+        });
+  }
+  return out;
+}
+
+} // namespace string_utf
+
+template <typename Allocator = std::allocator<char16_t>>
+inline BasicString<char16_t, std::char_traits<char16_t>, Allocator>
+to_utf16(std::string_view utf8, const Allocator &alloc = Allocator()) {
+  return string_utf::widen<
+      BasicString<char16_t, std::char_traits<char16_t>, Allocator>>(utf8,
+                                                                    alloc);
+}
+
+template <typename Allocator = std::allocator<char32_t>>
+inline BasicString<char32_t, std::char_traits<char32_t>, Allocator>
+to_utf32(std::string_view utf8, const Allocator &alloc = Allocator()) {
+  return string_utf::widen<
+      BasicString<char32_t, std::char_traits<char32_t>, Allocator>>(utf8,
+                                                                    alloc);
+}
+
+// UTF-16 or UTF-32, whichever wchar_t holds on this platform.
+template <typename Allocator = std::allocator<wchar_t>>
+inline BasicString<wchar_t, std::char_traits<wchar_t>, Allocator>
+to_wide(std::string_view utf8, const Allocator &alloc = Allocator()) {
+  return string_utf::widen<
+      BasicString<wchar_t, std::char_traits<wchar_t>, Allocator>>(utf8,
+                                                                  alloc);
+}
+
+template <typename Allocator = std::allocator<char>>
+inline BasicString<char, std::char_traits<char>, Allocator>
+to_utf8(std::u16string_view utf16, const Allocator &alloc = Allocator()) {
+  return string_utf::narrow<BasicString<char, std::char_traits<char>,
+                                        Allocator>>(utf16, alloc);
+}
+
+template <typename Allocator = std::allocator<char>>
+inline BasicString<char, std::char_traits<char>, Allocator>
+to_utf8(std::u32string_view utf32, const Allocator &alloc = Allocator()) {
+  return string_utf::narrow<BasicString<char, std::char_traits<char>,
+                                        Allocator>>(utf32, alloc);
+}
+
+template <typename Allocator = std::allocator<char>>
+inline BasicString<char, std::char_traits<char>, Allocator>
+to_utf8(std::wstring_view wide, const Allocator &alloc = Allocator()) {
+  return string_utf::narrow<BasicString<char, std::char_traits<char>,
+                                        Allocator>>(wide, alloc);
+}
+
+#endif